@@ -10,11 +10,39 @@
 /**************************************************************************************
  *                                USED LIBRARY
  **************************************************************************************/
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <ctype.h>
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define HAVE_IO_URING  1
+#endif
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 /************************************************************************************************
  *                                 DEFINE VARIABLE
@@ -74,15 +102,146 @@
  * @def LENGTH_NUMBER
  * @brief The length of the magic number and the input string number for comparison.
  * @details Used for comparing the magic number and the input string number.
+ *          This is the default digit count of a game, `--digits` selects another one.
  */
 #define LENGTH_NUMBER  6 
 
+/**
+ * @def LENGTH_NUMBER_MAX
+ * @brief The maximum digit count of a game.
+ */
+#define LENGTH_NUMBER_MAX  64
+
+/**
+ * @def DIGIT_COUNT_CHOICES
+ * @brief Digit counts with a digit kernel (see `s_digit_kernels`), for the usage messages.
+ */
+#define DIGIT_COUNT_CHOICES  "6|8|12|16|24|32|48|64"
+
 /**
  * @def LENGTH_STRING_MAX
  * @brief The maximum length of the user name input string.
  */
 #define LENGTH_STRING_MAX  20
 
+/**
+ * @def COMPARE_ALL_MASK
+ * @brief Match mask of a guess with all LENGTH_NUMBER digits right (bit i set when digit i matches).
+ */
+#define COMPARE_ALL_MASK  ((uint8_t)((1u << LENGTH_NUMBER) - 1))
+
+/**
+ * @def PACKED_DIGITS_WORDS
+ * @brief Number of 64-bit words of a packed number (16 digits per word).
+ */
+#define PACKED_DIGITS_WORDS  (LENGTH_NUMBER_MAX / 16)
+
+/**
+ * @brief Match mask of up to LENGTH_NUMBER_MAX digits (bit i set when digit i matches).
+ */
+typedef uint64_t digit_mask;
+
+/**
+ * @def DIGIT_MASK_ALL
+ * @brief Match mask of a guess with all `count` digits right.
+ */
+#define DIGIT_MASK_ALL(count)  (~(digit_mask)0 >> (64 - (count)))
+
+/**
+ * @struct packed_digits
+ * @brief Decimal digits of a number packed 4 bits per digit.
+ * @details Digit i (from the left of the printed number) is held in bits 4*(i%16) to
+ *          4*(i%16)+3 of `words[i/16]`; the nibbles after the last digit are 0.
+ *          A 6-digit number only uses the low 24 bits of `words[0]`.
+ */
+typedef struct {
+    uint64_t words[PACKED_DIGITS_WORDS];
+} packed_digits;
+
+/**
+ * @struct rng_state
+ * @brief State of a xoshiro256** random generator (one per session).
+ * @details Seeded from a 64-bit seed through splitmix64, so a seed replays the same games.
+ *          `rng_jump` moves a state 2^128 draws ahead to give independent streams.
+ */
+typedef struct {
+    uint64_t state[4];
+} rng_state;
+
+/**
+ * @struct digit_kernel
+ * @brief Validation, random and compare functions specialized for one digit count.
+ * @details The functions are generated by `DIGIT_KERNEL_DEFINE`, so the loops over the
+ *          digits and the words have a constant trip count for every digit count.
+ */
+typedef struct {
+    /** Digit count of the numbers handled by the kernel. */
+    int digitCount;
+
+    /** Returns 1 when `text` holds exactly `digitCount` digits, 0 otherwise. */
+    int (*check)(const char* text);
+
+    /** Packs the `digitCount` digits of a checked `text`. */
+    void (*parse)(const char* text, packed_digits* digits);
+
+    /** Creates a random number from one 64-bit draw per 16 digits. */
+    void (*random)(packed_digits* digits, rng_state* rng);
+
+    /** Returns the match mask of two numbers. */
+    digit_mask (*match)(const packed_digits* magicNumber, const packed_digits* inputNumber);
+} digit_kernel;
+
+/**
+ * @def COMPARE_HAS_SIMD
+ * @brief 1 when the SSE2/AVX2 compare kernels are built (x86 and an even LENGTH_NUMBER up to 8).
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && (LENGTH_NUMBER % 2 == 0) && (LENGTH_NUMBER <= 8)
+#define COMPARE_HAS_SIMD  1
+#else
+#define COMPARE_HAS_SIMD  0
+#endif
+
+/**
+ * @brief Batch compare kernel.
+ *
+ * @param magicNumbers `count` magic numbers of LENGTH_NUMBER digits, packed without terminator.
+ * @param inputNumbers `count` guesses of LENGTH_NUMBER digits, packed without terminator.
+ * @param count Number of (magic number, guess) pairs.
+ * @param matchMasks Output array receiving the match mask of every pair.
+ * @param isAllCorrect Output array receiving 1 for a pair with all digits right, or NULL.
+ */
+typedef void (*compare_batch_fn)(const char* magicNumbers, const char* inputNumbers, size_t count, uint8_t* matchMasks, uint8_t* isAllCorrect);
+
+/**
+ * @struct compare_kernel
+ * @brief A batch compare kernel and its name.
+ */
+typedef struct {
+    const char* name;
+    compare_batch_fn function;
+} compare_kernel;
+
+/**
+ * @struct guess_score
+ * @brief Score of one guess computed by `score_guess`.
+ */
+typedef struct {
+    /** Digits matched by the guess, revealed until the next guess. */
+    digit_mask commonMask;
+
+    /** Number of digits matched by the guess and not by the previous one. */
+    uint8_t newCorrectCount;
+
+    /** Number of digits matched by the previous guess and not by this one. */
+    uint8_t lostCount;
+
+    /** 1 when all digits are matched. */
+    uint8_t isAllCorrect;
+
+    /** Right guesses of the user after the guess. */
+    int32_t rightGuess;
+} guess_score;
+
 /**
  * @struct User
  * @brief Structure to hold user information.
@@ -96,1243 +255,8792 @@ typedef struct {
 } User;
 
 /**
- * @struct player_table
- * @brief Structure to hold 10 highest player 
- * @details Contains player name, lucky ratio, time record. 
+ * @def PLAYER_TABLE_MIN_NAMES
+ * @brief Number of slots of the name map of a new player table (always a power of 2).
  */
-typedef struct {
-    char playerName[10][LENGTH_STRING_MAX+1];
-    float luckyRatio[10]; 
-    float timeRecord[10]; 
-} player_table;
+#define PLAYER_TABLE_MIN_NAMES  64
 
 /**
- * @var magic_number
- * @brief Stores the random string number.
- * @details A character array with a length of LENGTH_NUMBER + 1 (6 digits + 1 null terminator).
+ * @def PLAYER_TREE_MAX_HEIGHT
+ * @brief Bound of the height of the player tree (an AVL tree of at most 2^31 players stays under 46).
  */
-char g_magic_number[LENGTH_NUMBER + 1];  
+#define PLAYER_TREE_MAX_HEIGHT  64
 
 /**
- * @var input_number
- * @brief Stores the input string number for comparison.
- * @details A character array with a length of LENGTH_NUMBER + 2 (7 digits + 1 null terminator + 1 extra character if needed).
+ * @def PLAYER_TABLE_PRINT_COUNT
+ * @brief Number of players printed by the high score table.
  */
-char g_input_number[LENGTH_NUMBER + 2];
+#define PLAYER_TABLE_PRINT_COUNT  10
 
 /**
- * @var common_char
- * @brief Stores the char in common.
- * @details A character array with a length of LENGTH_NUMBER + 1 (6 digits + 1 null terminator).
+ * @def PLAYER_TABLE_NEIGHBOR_COUNT
+ * @brief Number of players printed above and below a player in the "players around you" list.
  */
-char g_common_char[LENGTH_NUMBER+1];
+#define PLAYER_TABLE_NEIGHBOR_COUNT  2
 
 /**
- * @brief Array storing the magic numbers for the last 10 users.
- *
- * This array holds the magic numbers guessed by the last 10 users. Each element is a string
- * with a length of LENGTH_NUMBER + 1 to accommodate the null terminator.
+ * @struct player_node
+ * @brief Best result of one player, node of the player tree.
+ * @details `sequence` orders two equal results, the older one first. `size` is the number
+ *          of nodes of the subtree, which gives the rank of a node in O(log n).
  */
-char g_magic_number_old[10][LENGTH_NUMBER + 1]; 
+typedef struct {
+    char playerName[LENGTH_STRING_MAX + 1];
+    float luckyRatio;
+    float timeRecord;
+    uint64_t sequence;
+    int32_t left;
+    int32_t right;
+    int32_t height;
+    int32_t size;
+} player_node;
 
 /**
- * @brief Array storing the common character sequences for the last 10 users.
- *
- * This array holds the common character sequences for the last 10 users. Each element is a string
- * with a length of LENGTH_NUMBER + 1 to accommodate the null terminator.
+ * @struct player_table
+ * @brief Structure to hold the best result of every player, ranked.
+ * @details The nodes form an AVL tree ordered by lucky ratio (higher first), then time
+ *          record (lower first), so inserting or updating a result is O(log n) and the
+ *          top N players are the first N nodes of an in-order walk. `nameSlots` maps a
+ *          player name to its node (open addressing, -1 for an empty slot). When the table
+ *          is read from its file, `nodes` and `nameSlots` point into `mapping` until it grows.
  */
-char g_common_char_old[10][LENGTH_NUMBER + 1];
+typedef struct {
+    player_node* nodes;
+    int32_t nodeCount;
+    int32_t nodeCapacity;
+    int32_t root;
+    int32_t* nameSlots;
+    uint32_t nameCapacity;
+    uint64_t nextSequence;
+    void* mapping;
+    size_t mappingSize;
+} player_table;
 
 /**
- * @brief Array indicating if the last 10 users guessed the magic number correctly. (completing guess task flag)
- *
- * This array holds integer values indicating whether each of the last 10 users guessed
- * the magic number correctly. A value of 1 indicates a correct guess all digits, while 0 indicates
- * an incorrect guess.
+ * @def PLAYER_FILE
+ * @brief Binary file of the player table.
  */
-int  g_is_all_correct_string[10];
+#define PLAYER_FILE  "top_players.bin"
 
 /**
- * @brief Global flag indicating administrative status.
- *
- * This global variable is used to check whether the current user has administrative privileges.
- * The value of `g_check_admin` is typically set by the authentication or authorization system.
- * 
- * @note The variable should be set to a non-zero value if the user is an administrator,
- *       and to zero if the user does not have administrative privileges.
+ * @def PLAYER_FILE_MAGIC
+ * @brief Magic bytes at the beginning of the player table file.
  */
-int g_check_admin; 
-
-/************************************************************************************************
- *                                 DEFINE FUNCTION
- ***********************************************************************************************/
+#define PLAYER_FILE_MAGIC  "MOCKTOP"
 
 /**
- * @brief Displays the user interface menu for the Guess Game.
- *
- * This function prints the welcome message, menu options, and a special admin
- * message if the user is an admin. The printed text includes colored ASCII art.
- *
- * @param user The User structure containing the user's information. The function
- *             checks if the user's name is "nhathanh" to display the admin message.
+ * @def PLAYER_FILE_VERSION
+ * @brief Version of the player table file format (bumped when player_node changes).
  */
-void printf_interface(User user); 
+#define PLAYER_FILE_VERSION  1
 
 /**
- * @brief Prompts the user to enter a request and validates the input.
- *
- * This function prompts the user to enter a request, validates the input to ensure
- * it is a single character between '1' and '3'. If the input is invalid, it will
- * prompt the user to enter the request again until a valid input is received.
- *
- * @param userRequest A character array to store the user's request. The array must have a size of at least 3 characters.
+ * @struct player_file_header
+ * @brief Header of the player table file, followed by `nodeCount` nodes and `nameCapacity` name slots.
+ * @details `checksum` covers the counts, the nodes and the name map.
  */
-void enter_request(char userRequest[3]); 
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t nodeSize;
+    int32_t nodeCount;
+    int32_t root;
+    uint32_t nameCapacity;
+    uint32_t reserved;
+    uint64_t nextSequence;
+    uint64_t checksum;
+} player_file_header;
 
 /**
- * @brief Inputs the user name.
- * @param user Pointer to the User struct.
- * @return Integer status code (1 for valid input, 0 for invalid input).
+ * @def GAME_HISTORY_DEFAULT_CAPACITY
+ * @brief Default number of games kept in the history (in memory and in log.bin).
  */
-int input_user_name(User* user); 
+#define GAME_HISTORY_DEFAULT_CAPACITY  4096
 
 /**
- * @brief Creates a random 6-digit number (magic number).
- * @details Generates a random number with 6 digits and stores it in the global variable `magic_number`.
+ * @def GAME_HISTORY_MAX_CAPACITY
+ * @brief Maximum number of games accepted for the `--history` option.
  */
-void random_6_digits_number(void); 
+#define GAME_HISTORY_MAX_CAPACITY  (1L << 26)
 
 /**
- * @brief Inputs a 6-digit number string for comparison.
- * @details Prompts the user to input a 6-digit number. The input is then compared with the magic number.
- * @return Integer status code (1 for valid input, 0 for invalid input).
+ * @struct game_entry
+ * @brief Structure to hold one game of the history.
+ * @details Keeps the user, the packed magic number, the mask of the common digits and the
+ *          completing guess task flag (1 if all digits were guessed).
  */
-int input_6_digits_number(void);
+typedef struct {
+    User user;
+    packed_digits magicNumber;
+    digit_mask commonMask;
+    int  digitCount;
+    int  isAllCorrect;
+} game_entry;
 
 /**
- * @brief Comparing magic number with input number. 
- * @details Determining common chars and their positions.
- * @param user Pointer to the User struct.
- * @return Integer status code (1 for all corrects, 0 for incorrect)
+ * @struct game_history
+ * @brief Ring buffer holding the last `capacity` games.
+ * @details `head` is the slot of the next insert, so inserting overwrites the oldest game
+ *          without moving any other entry. Use `game_history_at` to read the games,
+ *          index 0 being the newest one.
  */
-int compare_2_string(User* user); 
+typedef struct {
+    game_entry* entries;
+    size_t capacity;
+    size_t count;
+    size_t head;
+} game_history;
 
 /**
- * @brief Updates the player table with the current user's score.
- * 
- * @details This function calculates the user's luck ratio (RightGuess/TotalGuess)
- *          and compares it with the existing players in the `player_table`. If the
- *          user's ratio qualifies for the top 10 players, it inserts the user's
- *          information into the correct position, shifting lower-ranked players down.
- *
- * @param user Pointer to the User struct containing the current user's information.
- * @param top_players Pointer to the player struct containiung the 10 highest players information 
+ * @def PENDING_INDEX_FILE
+ * @brief File of the index of the unfinished games (one entry per user name).
  */
-void update_player_table(User* user, player_table* top_players);
+#define PENDING_INDEX_FILE  "pending.idx"
 
 /**
- * @brief Saves the top 10 players' information to a text file.
- * 
- * @details This function writes the names and lucky ratios of the top 10 players
- *          from the `player_table` to a file named "top_players.txt".
- *
- * @param top_players Pointer to the player_table struct containing the top players' information.
+ * @def PENDING_INDEX_MAGIC
+ * @brief Magic bytes at the beginning of the index file.
  */
-void save_player_table_to_file(const player_table* top_players);
+#define PENDING_INDEX_MAGIC  "MOCKIDX"
 
 /**
- * @brief Reads the top 10 players' information from a text file and stores it in the player_table.
- * 
- * @details This function opens the file named "top_players.txt", skips the first line, 
- *          reads each subsequent line character by character, and manually parses the player names 
- *          and their lucky ratios. It stores this information in the provided `player_table` structure.
- *
- * @param top_players Pointer to the player_table struct where the data will be stored.
- * @return Integer status code (1 for success, 0 for failure).
+ * @def PENDING_INDEX_VERSION
+ * @brief Version of the index file format (bumped when pending_slot changes).
  */
-int read_player_table_from_file(player_table* top_players);
+#define PENDING_INDEX_VERSION  4
 
 /**
- * @brief Prints the top 10 players from the given player table.
- *
- * This function reads the top 10 players from the provided player table and prints
- * their names, lucky ratios, and time records.
- *
- * @param top_players A pointer to a player_table structure containing the top players' information.
+ * @def PENDING_INDEX_MIN_CAPACITY
+ * @brief Number of slots of a new index (always a power of 2).
  */
-void print_high_score(player_table *top_players); 
+#define PENDING_INDEX_MIN_CAPACITY  1024
 
 /**
- * @brief Saves the list of users to a file named "log.txt".
- *
- * This function opens the "log.txt" file in write mode and writes the details
- * of each user in the provided users array to the file. The file is overwritten
- * if it already exists. Each user's details are written in a formatted manner,
- * and the file is closed after writing.
- *
- * @param users An array of User structures containing user details.
+ * @def PENDING_SLOT_EMPTY
+ * @brief Hash of a slot never used.
  */
-void save_user_list_to_file(User users[]); 
+#define PENDING_SLOT_EMPTY  0
 
 /**
- * @brief Saves a single user to the list of users and updates the file.
- *
- * This function inserts a new user at the beginning of the users array,
- * shifts existing users down to make room, and removes the oldest user
- * if the list exceeds 10 users. It also updates associated arrays for
- * magic numbers, common characters, and correctness status. Finally, it
- * saves the updated list to a file.
- *
- * @param users An array of User structures containing the current list of users.
- * @param user The new User structure to be added to the list.
- * @param isAllCorrect An integer indicating whether the user's guess was correct all .
+ * @def PENDING_SLOT_REMOVED
+ * @brief Hash of a slot whose game was finished (kept for the probing sequences).
  */
-void save_user_to_file(User users[],User user, int isAllCorrect); 
+#define PENDING_SLOT_REMOVED  1
 
 /**
- * @brief Load user list from the log file.
- * 
- * This function reads user information from a log file and stores it in the provided array of `User` structures.
- * It also clears the previous game state and checks if the input user has any incomplete games.
- * 
- * @param users Array of `User` structures where the loaded user information will be stored.
- * @param user The `User` structure representing the current user.
- * @return int Index of the current user with an incomplete game if found, otherwise -1.
+ * @struct pending_index_header
+ * @brief Header at the beginning of the index file, followed by `capacity` slots.
+ * @details `usedCount` counts the pending and the removed slots. `appliedSequence` is the
+ *          sequence of the last ring file record applied to the index (0 for none) whose
+ *          changes are saved: with a sync mode the slots are synced before it moves on, so
+ *          the records after it are replayed after a crash.
  */
-int load_user_list_from_file(User users[], User user);
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t slotSize;
+    uint64_t capacity;
+    uint64_t count;
+    uint64_t usedCount;
+    uint64_t appliedSequence;
+} pending_index_header;
 
 /**
- * @brief Unit test function to enter and print user's request.
- *
- * This function tests the `enter_request` function by prompting the user to enter a request,
- * storing it in a static array, and then printing the entered request to verify its correctness.
- *
- * The function clears the request buffer, invokes the `enter_request` function to accept user input,
- * and then prints the request to the console for verification.
- *
- * @note The `enter_request` function should take a char array as input and populate it with the user's request.
+ * @struct pending_slot
+ * @brief Unfinished game of one user in the index.
  */
-void ut_enter_request(void); 
+typedef struct {
+    uint64_t hash;
+    char userName[LENGTH_STRING_MAX + 2];
+    uint8_t digitCount;
+    int32_t totalGuess;
+    int32_t rightGuess;
+    float timeRecord;
+    digit_mask commonMask;
+    packed_digits magicNumber;
+} pending_slot;
 
 /**
- * @brief Unit test function to input and validate user's name.
- *
- * This function tests the `input_user_name` function by prompting the user to enter a name,
- * storing it in a User struct, and then printing the validation results.
- *
- * The function clears the user name buffer, invokes the `input_user_name` function to accept user input,
- * checks if the input is valid and if the string length is within the maximum allowed length,
- * and then prints the validation results to the console for verification.
- *
- * @note The `input_user_name` function should take a User struct pointer as input and populate it with the user's name.
+ * @struct pending_index
+ * @brief Open addressing hash table from a user name to the unfinished game of the user.
+ * @details The header and the slots are mapped from the index file (`path`), or from
+ *          anonymous memory when `path` is NULL, so a lookup needs no read and no parsing.
+ *          `appliedSequence` is the last record applied, written to the header by
+ *          pending_index_sync.
  */
-void ut_input_user_name(void); 
+typedef struct {
+    pending_index_header* header;
+    pending_slot* slots;
+    size_t mappingSize;
+    int fd;
+    const char* path;
+    uint64_t appliedSequence;
+} pending_index;
 
 /**
- * @brief Unit test function to generate and print a random 6-digit number.
- *
- * This function tests the `random_6_digits_number` function by generating a random 6-digit number,
- * storing it in a static character array, and then printing the generated number to verify its correctness.
- *
- * The function invokes the `random_6_digits_number` function to generate the random number,
- * copies the global magic number to a local variable for printing, and then clears the global magic number.
- *
- * @note The `random_6_digits_number` function should generate a 6-digit number and store it in a global variable `g_magic_number`.
+ * @brief Background writer of the files of a persistent store (defined with the log records).
  */
-void ut_random_6_digits_number(void);
+typedef struct persist_writer persist_writer;
 
 /**
- * @brief Unit test function to input and validate a 6-digit number.
- *
- * This function tests the `input_6_digits_number` function by prompting the user to input a 6-digit number,
- * validating the input, and then printing the validation result to verify its correctness.
- *
- * The function invokes the `input_6_digits_number` function to accept and validate the user's input,
- * prints whether the input was valid or if the game should stop, and then clears the global input number.
- *
- * @note The `input_6_digits_number` function should validate a 6-digit number entered by the user and return:
- *       1 if the input is valid,
- *      -1 if the game should stop.
+ * @struct game_store
+ * @brief Structure to hold the state shared by all sessions of a front end.
+ * @details Holds the history, the player table and the index of the unfinished games.
+ *          When `isPersistent` is set, they are loaded once from their files when the store is
+ *          initialized and saved to their files by the `writer` thread when a game ends; otherwise
+ *          they only live in memory.
+ *          `mutex` must be held around every access because sessions of different threads may share
+ *          the store. The sessions look up and update `pending` in memory; a persistent store
+ *          copies it from the index file (`s_pending_file_index`, shared by the persistent stores and
+ *          accessed under `s_file_mutex`), which follows the ring file: a record is applied to it
+ *          once it is written, and the newer records are replayed when it is opened.
  */
-void ut_input_6_digits_number(void);
+typedef struct {
+    game_history history;
+    player_table topPlayers;
+    pending_index* pending;
+    pending_index memoryPending;
+    int isPersistent;
+    pthread_mutex_t mutex;
+
+    /** Writer thread of a persistent store (NULL: the files are written by the sessions). */
+    persist_writer* writer;
+} game_store;
 
 /**
- * @brief Unit test function to compare two strings and print the results.
- *
- * This function tests the `compare_2_string` function by comparing a predefined magic number
- * with different input numbers, storing the results, and then printing the comparison results to verify correctness.
- *
- * The function sets predefined values for the global magic number and input number,
- * invokes the `compare_2_string` function to compare these strings,
- * prints the result indicating whether all numbers are guessed correctly,
- * and the common characters between the strings.
- *
- * @note The `compare_2_string` function should compare the global magic number (`g_magic_number`) 
- *       with the global input number (`g_input_number`) and return:
- *       1 if all characters match,
- *       0 otherwise.
+ * @enum game_state
+ * @brief Phase of the menu/play/quit flow a session is waiting an input line for.
  */
-void ut_compare_2_string(void);
+typedef enum {
+    GAME_STATE_MENU,          /**< Waiting for a menu request. */
+    GAME_STATE_USER_NAME,     /**< Waiting for the user name of a new account. */
+    GAME_STATE_PLAY,          /**< Waiting for a 6-digit guess or "quit". */
+    GAME_STATE_HIGH_SCORE,    /**< Waiting for the y/N answer of the 10 highest table. */
+    GAME_STATE_STOPPED        /**< The program (or the connection) has to stop. */
+} game_state;
 
 /**
- * @brief Unit test function to load, read, save, and print top player data from/to a file.
- *
- * This function tests the sequence of operations for managing top player data by performing the following steps:
- * 1. Reading the player table from a file.
- * 2. Printing the high scores.
- * 3. Updating the player table with a new player's data.
- * 4. Saving the updated player table back to the file.
- * 5. Printing the high scores again to verify the update.
- *
- * The function initializes a `User` struct with a sample username, performs file operations
- * using `read_player_table_from_file`, `print_high_score`, `update_player_table`, and `save_player_table_to_file`,
- * and prints the high scores before and after updating to ensure the data is correctly managed.
+ * @brief Output sink of a session.
  *
- * @note The `read_player_table_from_file` function should read player data from a file and populate the `player_table`.
- * @note The `print_high_score` function should display the current high scores from the `player_table`.
- * @note The `update_player_table` function should update the player table with the data from the `User` struct.
- * @note The `save_player_table_to_file` function should save the updated player table back to the file.
+ * @param context The `outputContext` of the session.
+ * @param text The text printed by the session (not null terminated).
+ * @param length The length of the text.
  */
-void ut_load_read_save_print_top_file(void);
+typedef void (*output_fn)(void* context, const char* text, size_t length);
 
 /**
- * @brief Unit test for saving and reading data of file log.
- *
- * This function tests the `save_user_to_file` and `load_user_list_from_file` functions
- * by loading a user list from a file, modifying a user's data, saving the data back to the file, 
- * and then instructing the user to check the file for correctness.
- * 
- * @note the `save_user_to_file` functions should save the user to the file
- * @note the `load_user_list_from_file` function should read users data from a file
+ * @struct game_session
+ * @brief Structure to hold the state of one game session.
+ * @details Every session owns its magic number, input number, common digits, admin flag,
+ *          random seed and the state of its menu/play/quit flow, so many sessions can run
+ *          at the same time (one per thread or many per thread) without sharing any game state.
+ *          The flow is resumable: `game_step` consumes one input line and returns without blocking.
  */
-void ut_save_and_load_file(void);
+typedef struct {
+    /** Stores the random number (packed digits). */
+    packed_digits magicNumber;
 
-/**************************************************************************************
- *                                MAIN PROGRAM
- **************************************************************************************/
-int main(void)
-{   
+    /** Stores the input number for comparison (packed digits). */
+    packed_digits inputNumber;
 
-    /****************************************
-    *           Clear varible               *
-    *****************************************/
-    /*Create a user instance*/
+    /** Stores the digits in common with the last guess (bit i set when digit i matched). */
+    digit_mask commonMask;
+
+    /** Digit kernel of the game in progress (a resumed game keeps its digit count). */
+    const digit_kernel* digitKernel;
+
+    /** Digit count of the new games (LENGTH_NUMBER by default). */
+    int digitCount;
+
+    /** Flag indicating administrative status (non-zero for the administrator). */
+    int isAdmin;
+
+    /** Random generator of the session (magic numbers). */
+    rng_state rng;
+
+    /** Phase of the flow waiting for the next input line. */
+    game_state state;
+
+    /** Current user: account and score of the game in progress. */
     User user;
-    User users[10]; 
 
-    /*Clear all variables of struct*/
-    user.totalGuess = 0;
-    user.rightGuess = 0;
-    user.timeRecord = 0;
-    memset(user.userName,'\0',sizeof(user.userName)); 
+    /** Start time of the game in progress. */
+    time_t startTime;
 
-    /*Create a top player instance*/
-    player_table top_players; 
+    /** Allows the "nhathanh" account to open the unit test menu (terminal only). */
+    int isAdminAllowed;
 
-    /*Clear all variables of struct*/
-    for (int i = 0; i < 10; i++) {
-        memset(top_players.playerName[i], '\0', LENGTH_STRING_MAX+1);
-        top_players.luckyRatio[i] = 0.0f;
-        top_players.timeRecord[i] = 0.0f; 
-    } 
+    /** Prints the magic number when a game starts, for fast checking. */
+    int isMagicShown;
 
-    /*clear struct*/
-    for (int i = 0; i < 10; i++) {
-        memset(users[i].userName, '\0', sizeof(users[i].userName));
-        users[i].rightGuess = 0;
-        users[i].totalGuess = 0;
-        users[i].timeRecord = 0.0f;
-    }
+    /** Prints the menus without ASCII art and color codes. */
+    int isPlain;
 
-    /*clear common_char_old + magic_number_old*/
-    memset(g_common_char_old,'\0', sizeof(g_common_char_old)); 
-    memset(g_magic_number_old,'\0',sizeof(g_magic_number_old));
+    /** Store shared with the other sessions of the front end. */
+    game_store* store;
 
-    /*Check the input valid*/
-    int isValid = 0; 
+    /** Output sink and its context, NULL for a headless session (nothing is formatted at all). */
+    output_fn output;
+    void* outputContext;
 
-    /*Check magic number is determined*/
-    int isAllCorrect = 0; 
+    /** Set by a front end which must not block (the server): in commit mode a finished game leaves
+        the ticket of its record in `commitTicket` instead of waiting for it, and the front end holds
+        the session until game_session_commit_poll reports the record saved. */
+    int isCommitDeferred;
+    uint64_t commitTicket;
+} game_session;
 
-    /*Stop game*/
-    int stopGame = 0; 
+/** @def SESSION_COLOR
+ *  @brief Selects a color code for a session, or an empty string when the session prints plain text.
+ */
+#define SESSION_COLOR(session, color)  ((session)->isPlain ? "" : (color))
 
-    /*Storing time of guessing action*/
-    time_t startTime, endTime; 
+/**
+ * @def GAME_LINE_MAX
+ * @brief Maximum length of one input line of a session.
+ * @details Longer lines are discarded and answered like an invalid input.
+ */
+#define GAME_LINE_MAX  64
 
-    /*Store position taken users struct*/
-    int userPostionString = -1;
+/**
+ * @def LINE_READER_SIZE
+ * @brief Size of the input buffer of a line reader (bytes read at once from its fd).
+ */
+#define LINE_READER_SIZE  4096
 
-    /*Determine initial time*/
-    int initCheck = 0; 
+/**
+ * @struct line_reader
+ * @brief Buffered reader of the input lines of a file descriptor (terminal or socket).
+ * @details Bytes are read in large chunks into `buffer`; the lines are handed out in place,
+ *          the newline char replaced by a null terminator, so no line is copied. Bytes in
+ *          [start, length) are not handed out yet. A line longer than `maxLength` is
+ *          discarded up to its newline char and reported as overlong.
+ */
+typedef struct {
+    int fd;
+    size_t maxLength;
+    char buffer[LINE_READER_SIZE];
+    size_t start;
+    size_t length;
 
-    /*avoid random data in the first time running program*/
-    for(int i = 0; i <= 10; i++)
-    {
-        save_user_to_file(users,user,0); 
-    }
+    /** Set while the rest of an overlong line is discarded. */
+    int isDiscarding;
 
-    /*Request compare*/
-    char requestComapre = '3'; 
-    /****************************************
-    *               PROGRAM                 *
-    *****************************************/
+    /** Set when the fd reached the end of input (or failed). */
+    int isEof;
+} line_reader;
 
-   /*Store the user's request*/
-    char userRequest[3];
+/**
+ * @def TERMINAL_SCREEN_SIZE
+ * @brief Size of the screen buffer of the terminal front end.
+ */
+#define TERMINAL_SCREEN_SIZE  8192
 
-    do
-    { 
+/**
+ * @struct terminal_screen
+ * @brief Output sink context of the terminal front end.
+ * @details The text printed by the session is composed in `text` and written to `fd` with a
+ *          single write when the front end waits for the next input line, so a whole screen
+ *          (menu, result, prompt) costs one system call.
+ */
+typedef struct {
+    char text[TERMINAL_SCREEN_SIZE];
+    size_t length;
+    int fd;
+} terminal_screen;
 
-    /*Clear StopGame*/
-    stopGame = 0; 
+/**
+ * @brief Mutex serializing the access to log.bin, log.txt and top_players.txt.
+ * @details Sessions running on different threads share the same files.
+ */
+static pthread_mutex_t s_file_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-    /*Check admin account*/
-    g_check_admin = (strcmp(user.userName,"nhathanh") == 0); 
+/**
+ * @brief Line reader of the standard input, shared by the terminal front end and the console input functions.
+ */
+static line_reader s_console_reader = { .fd = STDIN_FILENO, .maxLength = GAME_LINE_MAX };
 
-    /*Print interface game*/
-    printf_interface(user);  
+/**
+ * @def LOG_RING_FILE
+ * @brief Binary ring file of the games (one fixed record slot per game of the history).
+ */
+#define LOG_RING_FILE  "log.bin"
 
-    /*Enter request */
-    enter_request(userRequest); 
+/**
+ * @def LOG_RING_MAGIC
+ * @brief Magic bytes at the beginning of the ring file.
+ */
+#define LOG_RING_MAGIC  "MOCKLOG"
 
-    switch (g_check_admin)
+/**
+ * @def LOG_RING_VERSION
+ * @brief Version of the ring file format (bumped when log_record or the layout changes).
+ */
+#define LOG_RING_VERSION  4
+
+/**
+ * @struct log_ring_header
+ * @brief Header at the beginning of the ring file, followed by `capacity` record slots.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t capacity;
+} log_ring_header;
+
+/**
+ * @struct log_record
+ * @brief Fixed-size record of one game in the ring file.
+ * @details The game number `sequence` (starting from 1, 0 for an empty slot) selects the
+ *          slot `sequence % capacity`, so the newest game overwrites the oldest one.
+ */
+typedef struct {
+    uint64_t sequence;
+    char userName[LENGTH_STRING_MAX + 2];
+    uint8_t digitCount;
+    uint8_t isAllCorrect;
+    int32_t totalGuess;
+    int32_t rightGuess;
+    float timeRecord;
+    digit_mask commonMask;
+    packed_digits magicNumber;
+} log_record;
+
+/**
+ * @brief File descriptor of the ring file (opened on first use, -1 before), its number of
+ *        slots and the sequence number of the next game.
+ * @details Protected by `s_file_mutex`.
+ */
+static int s_log_ring_fd = -1;
+static uint64_t s_log_ring_capacity = 0;
+static uint64_t s_log_ring_next = 1;
+
+/**
+ * @brief Index of the unfinished games shared by the persistent stores, and its number of users.
+ * @details Protected by `s_file_mutex`.
+ */
+static pending_index s_pending_file_index;
+static int s_pending_file_users = 0;
+
+/**
+ * @def PERSIST_QUEUE_CAPACITY
+ * @brief Number of game records the writer queue holds before the sessions wait for the writer.
+ */
+#define PERSIST_QUEUE_CAPACITY  1024
+
+/**
+ * @def PERSIST_FAILED_RANGES
+ * @brief Number of ranges of failed records a writer remembers (see persist_writer).
+ */
+#define PERSIST_FAILED_RANGES  16
+
+/**
+ * @enum persist_sync_mode
+ * @brief Durability of the game records written by the writer threads (`--sync`).
+ */
+typedef enum {
+    PERSIST_SYNC_NONE,      /**< Never synced, a crash of the machine may lose the last games. */
+    PERSIST_SYNC_BATCH,     /**< One fdatasync per batch, the sessions do not wait for it. */
+    PERSIST_SYNC_COMMIT,    /**< One fdatasync per batch, a game goes on once its record is synced. */
+    PERSIST_SYNC_MODE_COUNT
+} persist_sync_mode;
+
+/**
+ * @def PERSIST_SYNC_DEFAULT_INTERVAL_MS
+ * @brief Default time the writer gathers a batch before syncing it (`--sync-interval`).
+ * @details 0 syncs at once: the records queued during a sync form the next batch, so the
+ *          batches grow with the load without delaying a lone session.
+ */
+#define PERSIST_SYNC_DEFAULT_INTERVAL_MS  0
+
+/**
+ * @def PERSIST_SYNC_MAX_INTERVAL_MS
+ * @brief Maximum value of `--sync-interval`.
+ */
+#define PERSIST_SYNC_MAX_INTERVAL_MS  1000
+
+/**
+ * @def PERSIST_SYNC_DEFAULT_BATCH
+ * @brief Default number of records which ends the gathering of a batch early (`--sync-batch`).
+ */
+#define PERSIST_SYNC_DEFAULT_BATCH  64
+
+/**
+ * @enum persist_io_backend
+ * @brief System calls the writer threads write the ring file with (`--io`).
+ */
+typedef enum {
+    PERSIST_IO_URING,       /**< One io_uring submission per batch, pwrite when io_uring is not available. */
+    PERSIST_IO_PWRITE,      /**< pwrite and fdatasync. */
+    PERSIST_IO_BACKEND_COUNT
+} persist_io_backend;
+
+/**
+ * @def PERSIST_USAGE
+ * @brief The writer options, for the usage messages.
+ */
+#define PERSIST_USAGE  "[--sync none|batch|commit] [--sync-interval 0..1000] [--sync-batch 1..1024] [--io uring|pwrite]"
+
+/**
+ * @struct persist_options
+ * @brief Durability settings of the writer threads, shared by all persistent stores.
+ * @details With a sync mode other than none, the writer waits up to `intervalMs` after the
+ *          first queued record, or until `batchSize` records are queued, then writes the batch
+ *          and syncs the ring file once: a longer interval or a larger batch gives fewer syncs
+ *          (throughput), a shorter one gives a smaller loss window or wait (latency).
+ */
+typedef struct {
+    persist_sync_mode mode;
+    long intervalMs;
+    long batchSize;
+    persist_io_backend io;
+} persist_options;
+
+/**
+ * @def PERSIST_BATCH_BUCKETS
+ * @brief Number of batch size buckets of the writer counters (1, 2-3, 4-7, ... up to the queue capacity).
+ */
+#define PERSIST_BATCH_BUCKETS  11
+
+/**
+ * @struct persist_stats
+ * @brief Counters of the writer threads, added to the process totals when a writer stops.
+ */
+typedef struct {
+    uint64_t recordCount;
+    uint64_t batchCount;
+    uint64_t maxBatch;
+    uint64_t batchSizes[PERSIST_BATCH_BUCKETS];
+
+    /** Syncs of the ring file and the time spent in them. */
+    uint64_t syncCount;
+    double syncSeconds;
+
+    /** Wins queued and table saves written for them. */
+    uint64_t winCount;
+    uint64_t tableSaveCount;
+
+    /** Waits of the sessions: queue full, record not synced yet (commit mode). */
+    uint64_t fullWaitCount;
+    uint64_t commitWaitCount;
+
+    /** Batches written through io_uring, and system calls writing or syncing the ring file. */
+    uint64_t ringBatchCount;
+    uint64_t ioCallCount;
+
+    /** Batches whose write or sync failed. */
+    uint64_t failedBatchCount;
+} persist_stats;
+
+/**
+ * @def IO_RING_ENTRIES
+ * @brief Submission queue size of the io_uring of a writer (the writes of a batch and its sync,
+ *        or the table image and its sync).
+ */
+#define IO_RING_ENTRIES  8
+
+/**
+ * @struct io_ring
+ * @brief io_uring instance of a writer thread, used through the raw system calls.
+ * @details The submission and completion rings are shared with the kernel: the writer fills
+ *          submission entries and publishes them by moving the tail, then reads completions
+ *          from the head. `iovecs` hold the buffers of the writes until they complete.
+ */
+typedef struct {
+    int fd;
+#ifdef HAVE_IO_URING
+    void* sqMapping;
+    size_t sqMappingSize;
+    void* cqMapping;
+    size_t cqMappingSize;
+    struct io_uring_sqe* sqes;
+    size_t sqesSize;
+    unsigned* sqTail;
+    unsigned sqMask;
+    unsigned* sqArray;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned cqMask;
+    struct io_uring_cqe* cqes;
+    struct iovec iovecs[IO_RING_ENTRIES];
+#endif
+} io_ring;
+
+/**
+ * @brief Durability settings set from the command line, and the counters of the stopped writers.
+ * @details The settings are read when a writer starts. The counters are protected by `s_file_mutex`.
+ */
+static persist_options s_persist_options = { PERSIST_SYNC_NONE, PERSIST_SYNC_DEFAULT_INTERVAL_MS, PERSIST_SYNC_DEFAULT_BATCH, PERSIST_IO_URING };
+static persist_stats s_persist_stats;
+
+/**
+ * @brief Names of the sync modes, as given to `--sync`.
+ */
+static const char* const s_persist_sync_mode_names[PERSIST_SYNC_MODE_COUNT] = { "none", "batch", "commit" };
+
+/**
+ * @brief Names of the I/O backends, as given to `--io`.
+ */
+static const char* const s_persist_io_names[PERSIST_IO_BACKEND_COUNT] = { "uring", "pwrite" };
+
+/**
+ * @struct persist_writer
+ * @brief Bounded queue of the file updates of a persistent store, drained by a writer thread.
+ * @details The sessions queue the record of every finished or quit game and mark the player
+ *          table dirty after a win, then return without any file I/O. The writer takes all queued
+ *          records at once and writes them to the ring file; all wins since its last save are
+ *          covered by one save of the player table, copied under the store mutex and written
+ *          without it. A full queue makes the sessions wait (backpressure). Stopping the writer
+ *          writes everything still queued first. With a sync mode (see persist_options) the
+ *          records of a batch are written together and synced once (group commit).
+ */
+struct persist_writer {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+
+    /** Signaled when work is queued (writer) and when work is written (sessions, flush). */
+    pthread_cond_t wakeup;
+    pthread_cond_t progress;
+
+    /** Queued records, [head, head + count) modulo the capacity. */
+    log_record records[PERSIST_QUEUE_CAPACITY];
+    size_t head;
+    size_t count;
+
+    /** Batch taken by the writer, written without holding `mutex`. */
+    log_record batch[PERSIST_QUEUE_CAPACITY];
+
+    /** Set by a win, cleared when the writer copies the table. */
+    int isPlayerTableDirty;
+    int isBusy;
+    int isStopping;
+
+    /** Store the player table is copied from, under its mutex. */
+    player_table* topPlayers;
+    pthread_mutex_t* storeMutex;
+    player_table snapshot;
+
+    /** Settings read at start. */
+    persist_options options;
+
+    /** io_uring of the writer thread, when `isRingReady`. */
+    io_ring ring;
+    int isRingReady;
+
+    /** Called after every batch, under `mutex`, to wake the sessions which do not wait on `progress`. */
+    void (*notify)(void* context);
+    void* notifyContext;
+
+    /** Records queued, records the writer is done with, and records up to the last batch
+        written (and synced) without error. A record waits for `writtenCount` and is saved when
+        `durableCount` covers it and it is not in a failed batch. */
+    uint64_t queuedCount;
+    uint64_t writtenCount;
+    uint64_t durableCount;
+
+    /** Tickets [first, last] of the failed batches, oldest first, adjacent ones merged. With
+        too many the two oldest are merged: the records between them are reported failed too. */
+    uint64_t failedFirst[PERSIST_FAILED_RANGES];
+    uint64_t failedLast[PERSIST_FAILED_RANGES];
+    int failedRangeCount;
+
+    persist_stats stats;
+};
+
+/**
+ * @def SIMULATION_MAX_GUESSES
+ * @brief Maximum number of guesses of a simulated game before it is abandoned.
+ * @details Protects the simulation against a guesser which never finds the magic number.
+ */
+#define SIMULATION_MAX_GUESSES  1000
+
+/**
+ * @brief Scripted guesser used by the headless simulation.
+ *
+ * @param commonChar The chars revealed so far ('_' for an unknown position).
+ * @param guessCount The index of the guess being made (starting from 1).
+ * @param guess Output buffer receiving strlen(commonChar) digits and a null terminator.
+ * @param seed Per-session random seed the guesser may use.
+ */
+typedef void (*guesser_fn)(const char* commonChar, int guessCount, char* guess, unsigned int* seed);
+
+/**
+ * @def SIMULATION_MAX_THREADS
+ * @brief Maximum number of worker threads of the simulation.
+ */
+#define SIMULATION_MAX_THREADS  64
+
+/**
+ * @struct simulation_worker
+ * @brief Structure to hold the work and the result of one simulation thread.
+ */
+typedef struct {
+    long gameCount;
+    guesser_fn guesser;
+    int digitCount;
+    size_t historyCapacity;
+
+    /** Store shared by the workers when the files are enabled, NULL for a store in memory per worker. */
+    game_store* store;
+
+    /** Random stream of the worker (a jump ahead of the previous worker stream). */
+    rng_state rng;
+    long totalGuesses;
+    long totalRightGuesses;
+    long abandonedGames;
+} simulation_worker;
+
+/**
+ * @def SERVER_MAX_THREADS
+ * @brief Maximum number of event loop threads of the server.
+ */
+#define SERVER_MAX_THREADS  64
+
+/**
+ * @def SERVER_MAX_EVENTS
+ * @brief Maximum number of epoll events handled by one epoll_wait call.
+ */
+#define SERVER_MAX_EVENTS  256
+
+/**
+ * @struct server_connection
+ * @brief Structure to hold the non-blocking state of one client connection.
+ * @details Every connection owns its game session, an input line reader
+ *          and an output buffer flushed when the socket is writable.
+ */
+typedef struct server_connection {
+    int fd;
+    game_session session;
+
+    /** Links of the list of the connections of the owning worker. */
+    struct server_connection* previous;
+    struct server_connection* next;
+
+    /** Input lines of the client. */
+    line_reader input;
+
+    /** Pending output; bytes in [outSent, outLength) are not written yet. */
+    char* outBuffer;
+    size_t outLength;
+    size_t outSent;
+    size_t outCapacity;
+
+    /** Events the fd is currently registered for in the epoll instance. */
+    unsigned int epollEvents;
+
+    /** Set when the connection must be closed once its output is flushed. */
+    int isClosing;
+} server_connection;
+
+/**
+ * @struct game_server
+ * @brief Structure to hold the state shared by all connections of the server.
+ */
+typedef struct {
+    int listenFd;
+    int threadCount;
+    game_store store;
+
+    /** Seed base of the sessions, every connection gets the next value. */
+    uint64_t sessionSeed;
+
+    /** Digit count of the games of every connection. */
+    int digitCount;
+
+    /** Eventfd of every worker, written by the writer thread when a batch of records is done. */
+    int commitEventFds[SERVER_MAX_THREADS];
+} game_server;
+
+/**
+ * @struct server_worker
+ * @brief Structure to hold one event loop thread of the server.
+ * @details `connections` lists the open connections of the thread, so the ones still open
+ *          when the server stops are closed (and their games saved) before the store is closed.
+ */
+typedef struct {
+    game_server* server;
+    int epollFd;
+    int commitEventFd;
+    pthread_t thread;
+    server_connection* connections;
+} server_worker;
+
+/**
+ * @def LOADGEN_MAX_THREADS
+ * @brief Maximum number of threads of the load generator.
+ */
+#define LOADGEN_MAX_THREADS  64
+
+/**
+ * @def LOADGEN_MAX_BOTS
+ * @brief Maximum number of bots of the load generator, so every bot name fits in a user name.
+ */
+#define LOADGEN_MAX_BOTS  1000000
+
+/**
+ * @def LOADGEN_RESPONSE_SIZE
+ * @brief Size of the buffer receiving the answer of the game to one bot request.
+ */
+#define LOADGEN_RESPONSE_SIZE  4096
+
+/**
+ * @def LOADGEN_QUIT_GUESSES
+ * @brief Number of guesses after which a quitter bot quits its game, then resumes it.
+ */
+#define LOADGEN_QUIT_GUESSES  2
+
+/**
+ * @def LOADGEN_IDLE_TIMEOUT_MS
+ * @brief Time without any answer of the server after which the waiting bots are failed.
+ */
+#define LOADGEN_IDLE_TIMEOUT_MS  10000
+
+/**
+ * @enum bot_kind
+ * @brief Guessing behavior of a load generator bot.
+ */
+typedef enum {
+    BOT_KIND_RANDOM,          /**< Keeps the revealed digits, random digits elsewhere. */
+    BOT_KIND_SOLVER,          /**< Rules out the digits of every position from the "Result" feedback. */
+    BOT_KIND_QUITTER,         /**< Solver quitting every game midway, then resuming it. */
+    BOT_KIND_COUNT
+} bot_kind;
+
+/**
+ * @enum bot_step
+ * @brief Last request sent by a bot, the answer of the game is expected for it.
+ */
+typedef enum {
+    BOT_STEP_CONNECT,         /**< Connection (or session start), the menu is expected. */
+    BOT_STEP_CREATE,          /**< "1" (create account). */
+    BOT_STEP_NAME,            /**< User name. */
+    BOT_STEP_START,           /**< "2" (play), a new or resumed game. */
+    BOT_STEP_GUESS,           /**< A guess. */
+    BOT_STEP_QUIT,            /**< "quit". */
+    BOT_STEP_SCORE,           /**< "n" (no 10 highest table). */
+    BOT_STEP_EXIT,            /**< "3" (exit). */
+    BOT_STEP_DONE             /**< Nothing more to send. */
+} bot_step;
+
+/**
+ * @enum loadgen_phase
+ * @brief Phase of the game a request latency is reported for.
+ */
+typedef enum {
+    LOADGEN_PHASE_CONNECT,
+    LOADGEN_PHASE_ACCOUNT,
+    LOADGEN_PHASE_START,
+    LOADGEN_PHASE_RESUME,
+    LOADGEN_PHASE_GUESS,
+    LOADGEN_PHASE_WIN,
+    LOADGEN_PHASE_QUIT,
+    LOADGEN_PHASE_SCORE,
+    LOADGEN_PHASE_COUNT
+} loadgen_phase;
+
+/**
+ * @struct latency_samples
+ * @brief Growing array of request latencies (seconds).
+ */
+typedef struct {
+    double* values;
+    size_t count;
+    size_t capacity;
+} latency_samples;
+
+/**
+ * @struct loadgen_bot
+ * @brief State of one bot player of the load generator.
+ * @details A bot only knows what the game prints: it reads the "Result" line of every guess,
+ *          so it plays the same against the game engine and against the server.
+ */
+typedef struct {
+    bot_kind kind;
+    bot_step step;
+    char userName[LENGTH_STRING_MAX + 1];
+    long gamesLeft;
+
+    /** Guesses of the game in progress, quit already done by a quitter. */
+    int guessCount;
+    int hasQuit;
+
+    /** Revealed digits ('_' for an unknown position) and digits ruled out per position. */
+    char knownText[LENGTH_NUMBER_MAX + 1];
+    uint16_t triedDigits[LENGTH_NUMBER_MAX];
+
+    /** Last request (guess or menu answer), with room for the newline char. */
+    char line[LENGTH_NUMBER_MAX + 2];
+
+    /** rand_r seed of the random guesser. */
+    unsigned int seed;
+
+    /** Time the last request was sent, time its answer was complete. */
+    double sentTime;
+    double answerTime;
+
+    /** Answer of the game to the last request, null terminated. */
+    char response[LOADGEN_RESPONSE_SIZE];
+    size_t responseLength;
+
+    /** Session of the bot (game engine target) or socket (server target). */
+    game_session session;
+    int fd;
+} loadgen_bot;
+
+/**
+ * @struct loadgen_worker
+ * @brief Structure to hold the bots and the results of one load generator thread.
+ */
+typedef struct {
+    loadgen_bot* bots;
+    long botCount;
+
+    /** Server address, NULL to drive the game engine in process through `store`. */
+    const char* address;
+    game_store* store;
+    int digitCount;
+
+    latency_samples samples[LOADGEN_PHASE_COUNT];
+    long games;
+    long guesses;
+    long requests;
+    long failedBots;
+    pthread_t thread;
+} loadgen_worker;
+
+/**
+ * @def MICRO_BENCH_POOL_SIZE
+ * @brief Number of inputs (guesses, players) drawn for the micro benchmark.
+ */
+#define MICRO_BENCH_POOL_SIZE  4096
+
+/**
+ * @def MICRO_BENCH_DEFAULT_SAMPLES
+ * @brief Default number of timed samples of every micro benchmark operation.
+ */
+#define MICRO_BENCH_DEFAULT_SAMPLES  200
+
+/**
+ * @struct micro_bench_context
+ * @brief State shared by the operations timed by the micro benchmark.
+ */
+typedef struct {
+    game_store store;
+    game_session session;
+    player_table players;
+
+    /** Pools of inputs, used in turn by the timed operations. */
+    char inputTexts[MICRO_BENCH_POOL_SIZE][LENGTH_NUMBER_MAX + 1];
+    packed_digits inputNumbers[MICRO_BENCH_POOL_SIZE];
+    User users[MICRO_BENCH_POOL_SIZE];
+
+    /** Next pool entry. */
+    unsigned long cursor;
+} micro_bench_context;
+
+/**
+ * @struct micro_benchmark
+ * @brief One timed operation of the micro benchmark.
+ */
+typedef struct {
+    const char* name;
+
+    /** Operations per sample, so a sample lasts much longer than the clock resolution. */
+    long batch;
+
+    /** Runs the operation `count` times. */
+    void (*run)(micro_bench_context* context, long count);
+} micro_benchmark;
+
+/**
+ * @def SCRATCH_DIRECTORY_SIZE
+ * @brief Size of the path of a scratch directory ("/tmp/mock_scratch.XXXXXX").
+ */
+#define SCRATCH_DIRECTORY_SIZE  32
+
+/**
+ * @struct score_case
+ * @brief Scoring rule of a guess: previous and new match masks, right guesses before and after.
+ */
+typedef struct {
+    digit_mask commonMask;
+    digit_mask matchMask;
+    int32_t rightGuess;
+    int32_t expected;
+    uint8_t isAllCorrect;
+} score_case;
+
+/**
+ * @def TEST_OUTPUT_MAX
+ * @brief Size of the output captured from a session by the test runner.
+ */
+#define TEST_OUTPUT_MAX  16384
+
+/**
+ * @def TEST_MESSAGE_MAX
+ * @brief Size of the failure messages kept for one test case.
+ */
+#define TEST_MESSAGE_MAX  2048
+
+/**
+ * @struct test_output
+ * @brief Output sink of a session under test: the printed text, null terminated.
+ */
+typedef struct {
+    char text[TEST_OUTPUT_MAX];
+    size_t length;
+} test_output;
+
+/**
+ * @struct test_context
+ * @brief Checks of one test case and the message of every failed check.
+ */
+typedef struct {
+    int checkCount;
+    int failCount;
+    char messages[TEST_MESSAGE_MAX];
+    size_t messageLength;
+} test_context;
+
+/**
+ * @struct test_case
+ * @brief One case of the test runner.
+ */
+typedef struct {
+    const char* name;
+
+    /** Runs the checks of the case. */
+    void (*run)(test_context* context);
+} test_case;
+
+/** @def TEST_EXPECT
+ *  @brief Checks a condition of a test case, a failure records the condition and its line.
+ */
+#define TEST_EXPECT(context, condition)  test_expect((context), (condition) != 0, #condition, __LINE__)
+
+/************************************************************************************************
+ *                                 DEFINE FUNCTION
+ ***********************************************************************************************/
+
+/**
+ * @brief Initializes a game session.
+ *
+ * Clears all strings and flags of the session and seeds its random generator.
+ *
+ * @param session Pointer to the game_session struct.
+ * @param seed Seed of the session random generator.
+ */
+void game_session_init(game_session* session, uint64_t seed);
+
+/**
+ * @brief Allocates an empty game history.
+ *
+ * @param history Pointer to the game_history struct.
+ * @param capacity Number of games kept before the oldest one is overwritten.
+ * @return int 1 for success, 0 if the memory cannot be allocated.
+ */
+int game_history_init(game_history* history, size_t capacity);
+
+/**
+ * @brief Releases the memory of a game history.
+ *
+ * @param history Pointer to the game_history struct.
+ */
+void game_history_free(game_history* history);
+
+/**
+ * @brief Clears a game history (all entries).
+ *
+ * @param history Pointer to the game_history struct.
+ */
+void game_history_clear(game_history* history);
+
+/**
+ * @brief Takes the slot of a new game in the history, overwriting the oldest one when it is full.
+ * @details O(1), no entry is moved.
+ *
+ * @param history Pointer to the game_history struct.
+ * @return game_entry* The slot to fill, which becomes the newest game.
+ */
+game_entry* game_history_push(game_history* history);
+
+/**
+ * @brief Gets a game of the history.
+ *
+ * @param history Pointer to the game_history struct.
+ * @param index Index of the game, 0 being the newest one.
+ * @return const game_entry* The game, or NULL if the history holds fewer games.
+ */
+const game_entry* game_history_at(const game_history* history, size_t index);
+
+/**
+ * @brief Inserts a game at the beginning of the history, removing the oldest one when it is full (memory only).
+ *
+ * @param history Pointer to the game_history struct.
+ * @param session Pointer to the game_session struct of the game (magic number and common chars).
+ * @param user The User structure of the game.
+ * @param isAllCorrect An integer indicating whether the user's guess was correct all.
+ */
+void game_history_insert(game_history* history, const game_session* session, User user, int isAllCorrect);
+
+/**
+ * @brief Finds the unfinished game of a user in the history.
+ * @details Only the newest game of the user is considered: a game won or resumed later
+ *          hides the older unfinished ones.
+ *
+ * @param history Pointer to the game_history struct.
+ * @param user The `User` structure representing the current user.
+ * @return long Index of the unfinished game if found, otherwise -1.
+ */
+long game_history_find_unfinished(const game_history* history, User user);
+
+/**
+ * @brief Initializes a store shared by the sessions of a front end.
+ *
+ * Allocates the history and clears the player table. A persistent store loads the
+ * history from log.bin and the player table from top_players.txt when the files exist.
+ *
+ * @param store Pointer to the game_store struct.
+ * @param isPersistent Non-zero to load/save the history and player table files.
+ * @param historyCapacity Number of games kept in the history.
+ * @return int 1 for success, 0 for failure.
+ */
+int game_store_init(game_store* store, int isPersistent, size_t historyCapacity);
+
+/**
+ * @brief Releases a store.
+ * @details A persistent store exports its last games to log.txt first.
+ *
+ * @param store Pointer to the game_store struct.
+ */
+void game_store_close(game_store* store);
+
+/**
+ * @brief Prints formatted text through the output sink of a session.
+ * @details Nothing is formatted when the session has no output sink (headless session).
+ *
+ * @param session Pointer to the game_session struct.
+ * @param format printf-like format string.
+ */
+void session_printf(const game_session* session, const char* format, ...);
+
+/**
+ * @brief Starts the menu/play/quit flow of a session: prints the interface and waits for a request.
+ *
+ * @param session Pointer to the game_session struct.
+ */
+void game_session_start(game_session* session);
+
+/**
+ * @brief Steps the menu/play/quit flow of a session with one input line.
+ *
+ * The function never blocks: it validates the line for the current state (menu request,
+ * user name, guess, y/N answer), runs the action, prints the answer and the next prompt
+ * through the session output sink and moves the session to its next state.
+ *
+ * @param session Pointer to the game_session struct.
+ * @param line The input line (without the newline char), NULL for an overlong line.
+ */
+void game_step(game_session* session, const char* line);
+
+/**
+ * @brief Abandons the flow of a session (end of input or closed connection).
+ * @details A game in progress is saved like a "quit". The session is moved to GAME_STATE_STOPPED.
+ *
+ * @param session Pointer to the game_session struct.
+ */
+void game_session_abandon(game_session* session);
+
+/**
+ * @brief Checks the record a session with a deferred commit waits for (see `isCommitDeferred`).
+ * @details When the record is done, `commitTicket` is cleared and a record which could not be
+ *          saved is reported to the player.
+ *
+ * @param session Pointer to the game_session struct.
+ * @return int 1 when the session can go on, 0 while its record is not written and synced yet.
+ */
+int game_session_commit_poll(game_session* session);
+
+/**
+ * @brief Output sink of the terminal front end (writes to stdout).
+ *
+ * @param context Unused.
+ * @param text The text to print.
+ * @param length The length of the text.
+ */
+void terminal_output(void* context, const char* text, size_t length);
+
+/**
+ * @brief Output sink of the terminal front end composing a screen.
+ * @details Appends the text to the screen buffer, the full buffer is written first when the
+ *          text does not fit.
+ *
+ * @param context Pointer to the terminal_screen struct.
+ * @param text The text to print.
+ * @param length The length of the text.
+ */
+void terminal_screen_output(void* context, const char* text, size_t length);
+
+/**
+ * @brief Writes the composed screen with a single write and empties the buffer.
+ * @details The pending stdio output (unit test menu) is flushed first to keep the order.
+ *
+ * @param screen Pointer to the terminal_screen struct.
+ */
+void terminal_screen_flush(terminal_screen* screen);
+
+/**
+ * @brief Initializes a line reader on a file descriptor.
+ *
+ * @param reader Pointer to the line_reader struct.
+ * @param fd The file descriptor (blocking or non-blocking).
+ * @param maxLength Maximum length of a line (below LINE_READER_SIZE - 1), longer lines are reported as overlong.
+ */
+void line_reader_init(line_reader* reader, int fd, size_t maxLength);
+
+/**
+ * @brief Reads once from the fd of a line reader, as much as its buffer can take.
+ *
+ * @param reader Pointer to the line_reader struct.
+ * @return ssize_t Number of bytes read, 0 at the end of input, -1 on error (errno is kept,
+ *         EAGAIN for a non-blocking fd without data).
+ */
+ssize_t line_reader_fill(line_reader* reader);
+
+/**
+ * @brief Hands out the next buffered line without reading the fd.
+ * @details The line is null terminated in place (a carriage return before the newline char is
+ *          dropped) and stays valid until the next call. At the end of input, a last line
+ *          without newline char is handed out too.
+ *
+ * @param reader Pointer to the line_reader struct.
+ * @param line Receives the line (for a return value of 1).
+ * @return int 1 for a line, 0 for an overlong line (discarded), -1 at the end of input,
+ *         -2 when no complete line is buffered.
+ */
+int line_reader_next(line_reader* reader, char** line);
+
+/**
+ * @brief Reads the next line, reading the fd until a line is complete (blocking fd).
+ *
+ * @param reader Pointer to the line_reader struct.
+ * @param line Receives the line (for a return value of 1).
+ * @return int 1 for a line, 0 for an overlong line (discarded), -1 at the end of input.
+ */
+int line_reader_read(line_reader* reader, char** line);
+
+/**
+ * @brief Reads one input line of the terminal (standard input).
+ * @details Pending stdio output (prompts) is flushed first. Shared by the terminal front end
+ *          and the console input functions.
+ *
+ * @param line Receives the line without the newline char.
+ * @return int 1 for a line, 0 for an overlong line (discarded), -1 at the end of input.
+ */
+int terminal_read_line(char** line);
+
+/**
+ * @brief Displays the user interface menu for the Guess Game.
+ *
+ * This function prints the welcome message, menu options, and a special admin
+ * message if the user is an admin. The printed text includes colored ASCII art,
+ * which is left out for a plain session. The text goes through the session output sink.
+ *
+ * @param session Pointer to the game_session struct (its admin flag selects the admin menu).
+ */
+void printf_interface(const game_session* session); 
+
+/**
+ * @brief Prompts the user to enter a request and validates the input.
+ *
+ * This function prompts the user to enter a request, validates the input to ensure
+ * it is a single character between '1' and '3' ('1' and '9' for the administrator). If the input is invalid, it will
+ * prompt the user to enter the request again until a valid input is received.
+ * At the end of input, the request is left empty.
+ *
+ * @param session Pointer to the game_session struct.
+ * @param userRequest A character array to store the user's request. The array must have a size of at least 3 characters.
+ */
+void enter_request(const game_session* session, char userRequest[3]); 
+
+/**
+ * @brief Checks a request line without any console interaction.
+ *
+ * @param userRequest The request string (without the newline char).
+ * @param isAdmin Non-zero for the administrator menu ('1'..'9'), zero for the user menu ('1'..'3').
+ * @return Integer status code (1 for valid request, 0 for invalid request).
+ */
+int check_request(const char* userRequest, int isAdmin);
+
+/**
+ * @brief Checks a user name without any console interaction.
+ * @details The user name is valid if its length is at most LENGTH_STRING_MAX and it only holds alphanumeric chars.
+ * @param userName The user name string (without the newline char).
+ * @return Integer status code (1 for valid user name, 0 for invalid user name).
+ */
+int check_user_name(const char* userName);
+
+/**
+ * @brief Checks a number string of the game digit count without any console interaction.
+ * @param inputNumber The input number string (without the newline char).
+ * @param kernel The digit kernel of the game (6 digits by default).
+ * @return Integer status code (1 for valid input, 0 for invalid input, -1 for "quit").
+ */
+int check_6_digits_number(const char* inputNumber, const digit_kernel* kernel);
+
+/**
+ * @brief Inputs the user name.
+ * @param user Pointer to the User struct.
+ * @return Integer status code (1 for valid input, 0 for invalid input).
+ */
+int input_user_name(User* user); 
+
+/**
+ * @brief Creates a random 6-digit number (magic number).
+ * @details Generates a random number with the digit count of the game (6 by default) from
+ *          the session random generator and stores it in the session `magicNumber`.
+ * @param session Pointer to the game_session struct.
+ */
+void random_6_digits_number(game_session* session); 
+
+/**
+ * @brief Inputs a 6-digit number string for comparison.
+ * @details Prompts the user to input a 6-digit number into the session `inputNumber`.
+ *          The input is then compared with the magic number.
+ * @param session Pointer to the game_session struct.
+ * @return Integer status code (1 for valid input, 0 for invalid input, -1 for "quit" or the end of input).
+ */
+int input_6_digits_number(game_session* session);
+
+/**
+ * @brief Comparing magic number with input number. 
+ * @details Determining common digits and their positions. The session `commonMask` is updated.
+ * @param session Pointer to the game_session struct.
+ * @param user Pointer to the User struct.
+ * @return Integer status code (1 for all corrects, 0 for incorrect)
+ */
+int compare_2_string(game_session* session, User* user); 
+
+/**
+ * @brief Seeds a random generator.
+ * @details The 4 state words are drawn from splitmix64, so close seeds give unrelated states.
+ * @param rng Pointer to the rng_state struct.
+ * @param seed The seed (the same seed gives the same draws).
+ */
+void rng_seed(rng_state* rng, uint64_t seed);
+
+/**
+ * @brief Draws the next 64-bit value (xoshiro256**).
+ * @param rng Pointer to the rng_state struct.
+ * @return uint64_t The random value.
+ */
+uint64_t rng_next(rng_state* rng);
+
+/**
+ * @brief Moves a random generator 2^128 draws ahead.
+ * @details Used to split one seed into non-overlapping streams (one per thread).
+ * @param rng Pointer to the rng_state struct.
+ */
+void rng_jump(rng_state* rng);
+
+/**
+ * @brief Parses the value of a `--seed` option.
+ * @param text The option value (decimal or 0x hexadecimal).
+ * @param seed Output seed.
+ * @return int 1 for a valid seed, 0 otherwise.
+ */
+int parse_seed(const char* text, uint64_t* seed);
+
+/**
+ * @brief Finds the digit kernel of a digit count.
+ * @param digitCount The digit count.
+ * @return const digit_kernel* The kernel, or NULL if no kernel is built for this digit count.
+ */
+const digit_kernel* digit_kernel_find(int digitCount);
+
+/**
+ * @brief Parses the value of a `--digits` option.
+ * @param text The option value.
+ * @return int The digit count, or 0 if no kernel is built for it.
+ */
+int parse_digit_count(const char* text);
+
+/**
+ * @brief Parses a writer option (`--sync`, `--sync-interval`, `--sync-batch`, `--io`) into the writer settings.
+ * @param argc Argument count.
+ * @param argv Argument values.
+ * @param index Index of the option, moved to its value when the option is consumed.
+ * @param isValid Set to 0 when the value is invalid.
+ * @return int 1 if the option is a writer option, 0 otherwise.
+ */
+int parse_persist_option(int argc, char* argv[], int* index, int* isValid);
+
+/**
+ * @brief Prints a packed number as a string.
+ * @param digits Pointer to the packed number.
+ * @param mask The digits to print (bit i set for digit i), the other ones are printed as '_'.
+ * @param digitCount The digit count of the number.
+ * @param text Output buffer of digitCount + 1 chars.
+ * @return char* The `text` buffer.
+ */
+char* packed_digits_format(const packed_digits* digits, digit_mask mask, int digitCount, char* text);
+
+/**
+ * @brief Compares the 16 digits of two packed words with a few word operations.
+ * @param magicWord A word of the packed magic number.
+ * @param inputWord The same word of the packed guess.
+ * @return digit_mask The match mask of the 16 digits (bit i set when digit i is equal).
+ */
+digit_mask packed_word_match(uint64_t magicWord, uint64_t inputWord);
+
+/**
+ * @brief Scores a guess from the match masks only (no I/O, no session).
+ * @details The right guesses grow by one when the guess matches new digits and loses none,
+ *          and drop by one (not under 0) when it loses digits and matches no new one.
+ * @param commonMask Digits matched by the previous guess.
+ * @param matchMask Digits matched by the guess (see `digit_kernel.match`).
+ * @param digitCount The digit count of the game.
+ * @param rightGuess Right guesses of the user before the guess.
+ * @return guess_score The score of the guess.
+ */
+guess_score score_guess(digit_mask commonMask, digit_mask matchMask, int digitCount, int32_t rightGuess);
+
+/**
+ * @brief Compares many (magic number, guess) pairs at once.
+ * @details Runs the best kernel supported by the CPU (AVX2, SSE2 or scalar), selected on the first call.
+ *
+ * @param magicNumbers `count` magic numbers of LENGTH_NUMBER digits, packed without terminator.
+ * @param inputNumbers `count` guesses of LENGTH_NUMBER digits, packed without terminator.
+ * @param count Number of pairs.
+ * @param matchMasks Output array receiving the match mask of every pair (bit i set when digit i matches).
+ * @param isAllCorrect Output array receiving 1 for a pair with all digits right, or NULL.
+ */
+void compare_batch(const char* magicNumbers, const char* inputNumbers, size_t count, uint8_t* matchMasks, uint8_t* isAllCorrect);
+
+/**
+ * @brief Batch compare kernel comparing one digit at a time (any CPU).
+ * @details Same parameters as `compare_batch`.
+ */
+void compare_batch_scalar(const char* magicNumbers, const char* inputNumbers, size_t count, uint8_t* matchMasks, uint8_t* isAllCorrect);
+
+#if COMPARE_HAS_SIMD
+/**
+ * @brief Batch compare kernel comparing 8 pairs with LENGTH_NUMBER / 2 SSE2 byte compares.
+ * @details Same parameters as `compare_batch`.
+ */
+void compare_batch_sse2(const char* magicNumbers, const char* inputNumbers, size_t count, uint8_t* matchMasks, uint8_t* isAllCorrect);
+
+/**
+ * @brief Batch compare kernel comparing 16 pairs with LENGTH_NUMBER / 2 AVX2 byte compares.
+ * @details Same parameters as `compare_batch`.
+ */
+void compare_batch_avx2(const char* magicNumbers, const char* inputNumbers, size_t count, uint8_t* matchMasks, uint8_t* isAllCorrect);
+#endif
+
+/**
+ * @brief Checks that the CPU supports a batch compare kernel.
+ * @param kernel Pointer to the compare_kernel struct.
+ * @return int Non-zero if the kernel can run.
+ */
+int compare_kernel_is_supported(const compare_kernel* kernel);
+
+/**
+ * @brief Gets the batch compare kernel selected for the CPU.
+ * @return const compare_kernel* The kernel run by `compare_batch`.
+ */
+const compare_kernel* compare_batch_kernel(void);
+
+/**
+ * @brief Updates the player table with the current user's score.
+ * 
+ * @details This function calculates the user's luck ratio (RightGuess/TotalGuess)
+ *          and keeps it in the `player_table` if it is the first or the best result
+ *          of the user.
+ *
+ * @param user Pointer to the User struct containing the current user's information.
+ * @param top_players Pointer to the player struct containiung the players information 
+ */
+void update_player_table(User* user, player_table* top_players);
+
+/**
+ * @brief Allocates an empty player table.
+ * @param table Pointer to the player_table struct.
+ * @return int 1 for success, 0 if the memory cannot be allocated.
+ */
+int player_table_init(player_table* table);
+
+/**
+ * @brief Releases the memory of a player table.
+ * @param table Pointer to the player_table struct.
+ */
+void player_table_free(player_table* table);
+
+/**
+ * @brief Removes all players of a player table.
+ * @param table Pointer to the player_table struct.
+ */
+void player_table_clear(player_table* table);
+
+/**
+ * @brief Saves a result of a player if it is the first or the best one of the player.
+ * @details O(log n): the node of the player is found by name and moved in the tree.
+ * @param table Pointer to the player_table struct.
+ * @param playerName The player name.
+ * @param luckyRatio The lucky ratio of the result.
+ * @param timeRecord The time record of the result.
+ * @return int 1 if the table changed, 0 if the player has a better result, -1 on failure.
+ */
+int player_table_update(player_table* table, const char* playerName, float luckyRatio, float timeRecord);
+
+/**
+ * @brief Gets the best players.
+ * @param table Pointer to the player_table struct.
+ * @param count Number of players wanted.
+ * @param players Output array receiving up to `count` players, the best one first.
+ * @return size_t Number of players written.
+ */
+size_t player_table_top(const player_table* table, size_t count, const player_node** players);
+
+/**
+ * @brief Gets the players of a range of ranks.
+ * @details O(log n + count): the walk starts at the node of rank `first + 1`.
+ * @param table Pointer to the player_table struct.
+ * @param first Number of better players skipped (0 starts at the best player).
+ * @param count Number of players wanted.
+ * @param players Output array receiving up to `count` players, the better one first.
+ * @return size_t Number of players written.
+ */
+size_t player_table_range(const player_table* table, size_t first, size_t count, const player_node** players);
+
+/**
+ * @brief Gets the global rank of a player.
+ * @details O(log n) using the subtree sizes.
+ * @param table Pointer to the player_table struct.
+ * @param playerName The player name.
+ * @return int32_t The rank (1 for the best player), 0 if the player has no result.
+ */
+int32_t player_table_rank(const player_table* table, const char* playerName);
+
+/**
+ * @brief Gets the percentile of a rank.
+ * @param table Pointer to the player_table struct.
+ * @param rank The rank (1 for the best player).
+ * @return float Percentage of the players ranked below.
+ */
+float player_table_percentile(const player_table* table, int32_t rank);
+
+/**
+ * @brief Copies a player table into a heap table, reusing the memory of the copy.
+ * @param copy Pointer to the copy (zeroed or a previous copy).
+ * @param table Pointer to the player_table struct to copy.
+ * @return int 1 for success, 0 for failure.
+ */
+int player_table_copy(player_table* copy, const player_table* table);
+
+/**
+ * @brief Saves the player table to the binary file "top_players.bin".
+ * 
+ * @details The file is the memory image of the table: a header (format version, counts
+ *          and checksum), the nodes of the tree and the name map, written with one `writev`
+ *          to a temporary file which then replaces the previous one.
+ *
+ * @param top_players Pointer to the player_table struct containing the top players' information.
+ */
+void save_player_table_to_file(const player_table* top_players);
+
+/**
+ * @brief Saves the player table like save_player_table_to_file, through an io_uring if given.
+ * @details With a ring the write of the image and its sync (`--sync`) are submitted together,
+ *          the sync linked after the write, and cost one system call instead of two.
+ * @param top_players Pointer to the player_table struct containing the top players' information.
+ * @param ring Pointer to the io_ring struct of the calling writer, NULL to use `writev`.
+ * @return int 1 for success, 0 for failure, -1 if the ring could not be used (the table is
+ *             saved, the ring must not be used any more).
+ */
+int player_table_save(const player_table* top_players, io_ring* ring);
+
+/**
+ * @brief Replaces a file by its complete temporary copy with an atomic rename.
+ * @details Readers see the old file or the new one, never a partial one. With a sync mode
+ *          (`--sync`) the copy is synced before the rename and its directory after it, so this
+ *          also holds after a power loss. On failure the copy is removed.
+ * @param fd File descriptor of the copy, left open, or -1 if the copy is already synced.
+ * @param tmpPath Path of the copy.
+ * @param path Path of the file to replace.
+ * @return int 1 for success, 0 for failure.
+ */
+int file_replace(int fd, const char* tmpPath, const char* path);
+
+/**
+ * @brief Reads the player table from the binary file "top_players.bin".
+ * 
+ * @details The file is mapped (private copy-on-write mapping) and, once its format and checksum
+ *          are checked, its nodes and name map are used in place: loading costs page faults
+ *          instead of parsing.
+ *
+ * @param top_players Pointer to the player_table struct where the data will be stored.
+ * @return Integer status code (1 for success, 0 for failure).
+ */
+int read_player_table_from_file(player_table* top_players);
+
+/**
+ * @brief Computes the checksum of a player table file.
+ * @param header Pointer to the header (counts of the table).
+ * @param nodes Pointer to the `header->nodeCount` nodes.
+ * @param nameSlots Pointer to the `header->nameCapacity` slots of the name map.
+ * @return uint64_t The checksum.
+ */
+uint64_t player_table_checksum(const player_file_header* header, const player_node* nodes, const int32_t* nameSlots);
+
+/**
+ * @brief Exports the players' information to a text file.
+ * 
+ * @details This function writes the names and lucky ratios of all the players,
+ *          ranked, from the `player_table` to a copy of "top_players.txt", which then
+ *          replaces the previous one (see file_replace).
+ *
+ * @note top_players.txt is a human-readable export only, refreshed when a persistent store is closed.
+ *
+ * @param top_players Pointer to the player_table struct containing the top players' information.
+ */
+void export_player_table_to_text(const player_table* top_players);
+
+/**
+ * @brief Imports the players' information from a text file and stores it in the player_table.
+ * 
+ * @details This function opens the file named "top_players.txt", skips the first line, 
+ *          reads each subsequent line character by character, and manually parses the player names 
+ *          and their lucky ratios. It stores this information in the provided `player_table` structure.
+ *          Used once to convert a text table saved by an older version.
+ *
+ * @param top_players Pointer to the player_table struct where the data will be stored.
+ * @return Integer status code (1 for success, 0 for failure).
+ */
+int import_player_table_from_text(player_table* top_players);
+
+/**
+ * @brief Prints the top 10 players from the given player table.
+ *
+ * This function reads the top 10 players from the provided player table and prints
+ * their names, lucky ratios, and time records through the session output sink.
+ *
+ * @param session Pointer to the game_session struct printing the table.
+ * @param top_players A pointer to a player_table structure containing the top players' information.
+ */
+void print_high_score(const game_session* session, player_table *top_players); 
+
+/**
+ * @brief Prints the rank and the percentile of a player.
+ *
+ * @param session Pointer to the game_session struct printing the rank.
+ * @param top_players A pointer to a player_table structure containing the players' information.
+ * @param playerName The player name.
+ */
+void print_player_rank(const game_session* session, const player_table* top_players, const char* playerName);
+
+/**
+ * @brief Prints the players ranked around a player.
+ *
+ * This function prints the PLAYER_TABLE_NEIGHBOR_COUNT players ranked above
+ * and below the player, and the player.
+ *
+ * @param session Pointer to the game_session struct printing the list.
+ * @param top_players A pointer to a player_table structure containing the players' information.
+ * @param playerName The player name.
+ */
+void print_player_neighbors(const game_session* session, const player_table* top_players, const char* playerName);
+
+/**
+ * @brief Saves the list of users to a file named "log.txt".
+ *
+ * This function writes the details of the last 10 users in the provided history
+ * to a copy of the "log.txt" file, which then replaces the previous one (see file_replace).
+ * Each user's details are written in a formatted manner.
+ *
+ * @note log.txt is a human-readable export only: games are recorded in the ring file
+ *       (log.bin) and log.txt is refreshed when a persistent store is closed.
+ *
+ * @param history Pointer to the game_history struct containing user details.
+ */
+void save_user_list_to_file(const game_history* history); 
+
+/**
+ * @brief Saves a single user to the list of users and updates the file.
+ *
+ * This function inserts a new user at the beginning of the history,
+ * overwriting the oldest user when the history is full. It also stores
+ * the magic number, common characters and correctness status of the
+ * session. Finally, it writes one record into its slot of the ring file
+ * (log.bin), a single small write whatever the size of the history.
+ *
+ * @param history Pointer to the game_history struct containing the current list of users.
+ * @param session Pointer to the game_session struct of the saved game.
+ * @param user The new User structure to be added to the list.
+ * @param isAllCorrect An integer indicating whether the user's guess was correct all .
+ */
+void save_user_to_file(game_history* history, const game_session* session, User user, int isAllCorrect); 
+
+/**
+ * @brief Load user list from the log file.
+ * 
+ * This function reads the games of the ring file (log.bin) and stores them in the provided history.
+ * It also clears the previous game state and checks if the input user has any incomplete games.
+ * 
+ * @param history Pointer to the game_history struct where the loaded user information will be stored.
+ * @param user The `User` structure representing the current user.
+ * @return int Index of the current user with an incomplete game if found, otherwise -1.
+ */
+long load_user_list_from_file(game_history* history, User user);
+
+/**
+ * @brief Opens the ring file (log.bin) if it is not open yet.
+ * @details Creates the file with `capacity` empty slots when it is missing or has another
+ *          format, and rebuilds it keeping the newest games when its capacity differs.
+ *          A file already open keeps its capacity. The caller must hold `s_file_mutex`.
+ * @param capacity Number of record slots of the file.
+ * @return int 1 for success, 0 for failure.
+ */
+int log_ring_open(uint64_t capacity);
+
+/**
+ * @brief Writes one record into its slot of the ring file.
+ * @details Gives the record the next sequence number. The caller must hold `s_file_mutex`.
+ * @param record Pointer to the log_record struct to write.
+ * @return int 1 for success, 0 for failure.
+ */
+int log_ring_append(log_record* record);
+
+/**
+ * @brief Writes consecutive records into their slots of the ring file, one write per contiguous run.
+ * @details Gives the records the next sequence numbers. The caller must hold `s_file_mutex`.
+ * @param records The log_record structs to write.
+ * @param count Number of records.
+ * @return int The number of writes (1 or more) for success, 0 for failure.
+ */
+int log_ring_write(log_record* records, size_t count);
+
+/**
+ * @brief Prepares the io_uring writes of consecutive records (and a sync after them).
+ * @details Gives the records the next sequence numbers and takes their slots, so the caller
+ *          submits the writes with io_ring_submit once it released `s_file_mutex`. Nothing is
+ *          changed when the batch is not prepared, the caller then writes it with log_ring_write.
+ *          The caller must hold `s_file_mutex`.
+ * @param ring Pointer to the io_ring struct.
+ * @param records The log_record structs to write, kept until the writes complete.
+ * @param count Number of records.
+ * @param isSynced Non-zero to sync the ring file once the writes are done.
+ * @return int The number of prepared operations, 0 if the batch is not prepared.
+ */
+int log_ring_prepare(io_ring* ring, log_record* records, size_t count, int isSynced);
+
+/**
+ * @brief Gives back the slots of a batch prepared by log_ring_prepare whose writes failed.
+ * @details The slots are only given back if no later game took the next ones, otherwise
+ *          they stay a hole which log_ring_open skips. The caller must hold `s_file_mutex`.
+ * @param records The log_record structs of the batch.
+ * @param count Number of records.
+ */
+void log_ring_release(const log_record* records, size_t count);
+
+/**
+ * @brief Prepares the write of a player table image to a file, and its sync, in the io_uring.
+ * @param ring Pointer to the io_ring struct.
+ * @param fd File descriptor of the file, written from its beginning.
+ * @param parts The parts of the image, kept until the write completes.
+ * @param count Number of parts, at most IO_RING_ENTRIES.
+ * @param isSynced Non-zero to sync the file once the write is done.
+ * @return int The number of prepared operations, 0 if the write is not prepared.
+ */
+int player_table_ring_prepare(io_ring* ring, int fd, const struct iovec* parts, int count, int isSynced);
+
+/**
+ * @brief Creates an io_uring and maps its rings.
+ * @param ring Pointer to the io_ring struct.
+ * @param entries Size of the submission queue.
+ * @return int 1 for success, 0 if io_uring is not available.
+ */
+int io_ring_init(io_ring* ring, unsigned entries);
+
+/**
+ * @brief Unmaps the rings and closes the io_uring.
+ * @param ring Pointer to the io_ring struct.
+ */
+void io_ring_free(io_ring* ring);
+
+/**
+ * @brief Submits the prepared operations and waits for them with one system call.
+ * @details The operations the kernel does not take run here with pwritev and fsync (or
+ *          fdatasync), once the ones it took are complete, and the ring must not be used any more.
+ * @param ring Pointer to the io_ring struct.
+ * @param count Number of prepared operations.
+ * @param callCount Incremented by the number of system calls made.
+ * @return int 1 if every operation succeeded (writes complete), -1 if they succeeded without
+ *             the ring, 0 if one failed.
+ */
+int io_ring_submit(io_ring* ring, unsigned count, uint64_t* callCount);
+
+/**
+ * @brief Closes the ring file, the next access opens it again (in the current directory).
+ * @details The caller must hold `s_file_mutex`.
+ */
+void log_ring_close(void);
+
+/**
+ * @brief Reads the games of the ring file into a history, oldest first.
+ * @details Opens the file with the capacity of the history. When the file holds more games
+ *          than the history, only the newest ones are kept. The caller must hold `s_file_mutex`.
+ * @param history Pointer to the game_history struct (cleared first).
+ * @return long Number of games read, -1 on failure.
+ */
+long log_ring_load(game_history* history);
+
+/**
+ * @brief Brings an index of the unfinished games up to date with the ring file.
+ * @details Replays the records newer than the last one applied to the index. An index ahead of
+ *          the ring file, or behind the oldest game it keeps, is rebuilt from the ring file.
+ *          The caller must hold `s_file_mutex`.
+ * @param index Pointer to the pending_index struct.
+ * @return long Number of records applied, -1 on failure.
+ */
+long log_ring_replay_pending(pending_index* index);
+
+/**
+ * @brief Starts the writer thread of a persistent store.
+ * @param store Pointer to the game_store struct (its player table is copied for the saves).
+ * @return persist_writer* The writer, NULL on failure (the sessions then write the files themselves).
+ */
+persist_writer* persist_writer_start(game_store* store);
+
+/**
+ * @brief Queues the record of a game, waiting for room when the queue is full.
+ * @details The caller must not hold the store mutex, the writer takes it to copy the player table.
+ * @param writer Pointer to the persist_writer struct.
+ * @param record Pointer to the log_record struct of the game.
+ * @param isWin Non-zero when the player table changed and must be saved.
+ * @return uint64_t Ticket of the record, for persist_writer_wait.
+ */
+uint64_t persist_writer_push(persist_writer* writer, const log_record* record, int isWin);
+
+/**
+ * @brief Waits until a queued record is written, and synced in a sync mode (group commit).
+ * @param writer Pointer to the persist_writer struct.
+ * @param ticket Ticket returned by persist_writer_push.
+ * @return int 1 when the record is saved, 0 when its batch could not be written or synced.
+ */
+int persist_writer_wait(persist_writer* writer, uint64_t ticket);
+
+/**
+ * @brief Checks a queued record without waiting.
+ * @param writer Pointer to the persist_writer struct.
+ * @param ticket Ticket returned by persist_writer_push.
+ * @return int -1 while the record is not written yet, otherwise like persist_writer_wait.
+ */
+int persist_writer_check(persist_writer* writer, uint64_t ticket);
+
+/**
+ * @brief Sets the function called after every batch (on the writer thread, keep it short).
+ * @param writer Pointer to the persist_writer struct.
+ * @param notify The function, NULL for none.
+ * @param context The argument of the function.
+ */
+void persist_writer_set_notify(persist_writer* writer, void (*notify)(void* context), void* context);
+
+/**
+ * @brief Waits until everything queued so far is written.
+ * @param writer Pointer to the persist_writer struct.
+ */
+void persist_writer_flush(persist_writer* writer);
+
+/**
+ * @brief Writes everything still queued, stops the writer thread and frees the writer.
+ * @param writer Pointer to the persist_writer struct.
+ */
+void persist_writer_stop(persist_writer* writer);
+
+/**
+ * @brief Reads the counters of the writers stopped so far.
+ * @param stats Output counters.
+ */
+void persist_stats_read(persist_stats* stats);
+
+/**
+ * @brief Prints the durability settings and the writer counters in the style of the reports.
+ * @param stats Pointer to the persist_stats struct.
+ */
+void persist_stats_print(const persist_stats* stats);
+
+/**
+ * @brief Hashes a user name for the index of the unfinished games and the player table.
+ * @param userName The user name.
+ * @return uint64_t The hash, never PENDING_SLOT_EMPTY nor PENDING_SLOT_REMOVED.
+ */
+uint64_t user_name_hash(const char* userName);
+
+/**
+ * @brief Opens an index of the unfinished games.
+ * @details Maps the index file when it exists with the current format, otherwise creates an
+ *          empty index. A NULL path gives an index in memory only.
+ * @param index Pointer to the pending_index struct.
+ * @param path Path of the index file, or NULL.
+ * @return int 1 for success, 0 for failure.
+ */
+int pending_index_open(pending_index* index, const char* path);
+
+/**
+ * @brief Closes an index of the unfinished games, after pending_index_sync.
+ * @param index Pointer to the pending_index struct.
+ */
+void pending_index_close(pending_index* index);
+
+/**
+ * @brief Saves the last applied record in the header of an index.
+ * @details With a sync mode (`--sync`) the slots of an index file are synced first, so the
+ *          header never names a record whose changes could still be lost.
+ * @param index Pointer to the pending_index struct.
+ */
+void pending_index_sync(pending_index* index);
+
+/**
+ * @brief Finds the unfinished game of a user.
+ * @param index Pointer to the pending_index struct.
+ * @param userName The user name.
+ * @return const pending_slot* The game, or NULL if the user has no unfinished game.
+ */
+const pending_slot* pending_index_find(const pending_index* index, const char* userName);
+
+/**
+ * @brief Saves the unfinished game of a user, replacing the previous one.
+ * @details The table grows when it is 70% full.
+ * @param index Pointer to the pending_index struct.
+ * @param user The user of the game.
+ * @param magicNumber Pointer to the packed magic number of the game.
+ * @param commonMask The mask of the common digits found so far.
+ * @param digitCount The digit count of the game.
+ * @return int 1 for success, 0 for failure.
+ */
+int pending_index_put(pending_index* index, User user, const packed_digits* magicNumber, digit_mask commonMask, int digitCount);
+
+/**
+ * @brief Removes the unfinished game of a user (the game was won).
+ * @param index Pointer to the pending_index struct.
+ * @param userName The user name.
+ */
+void pending_index_remove(pending_index* index, const char* userName);
+
+/**
+ * @brief Removes every game of an index (its capacity is kept).
+ * @param index Pointer to the pending_index struct.
+ */
+void pending_index_clear(pending_index* index);
+
+/**
+ * @brief Applies a ring file record to an index: a quit game is saved, a won game is removed.
+ * @details The index remembers the sequence of the record.
+ * @param index Pointer to the pending_index struct.
+ * @param record Pointer to the log_record struct.
+ * @return int 1 for success, 0 for failure.
+ */
+int pending_index_apply(pending_index* index, const log_record* record);
+
+/**
+ * @brief Copies the games of an index into another one.
+ * @param index Pointer to the pending_index struct receiving the games.
+ * @param source Pointer to the pending_index struct to copy.
+ * @return int 1 for success, 0 for failure.
+ */
+int pending_index_copy(pending_index* index, const pending_index* source);
+
+/**
+ * @brief Fills a ring file record from a game.
+ * @param record Pointer to the log_record struct to fill.
+ * @param session Pointer to the game session holding the magic number and common characters.
+ * @param user The user of the game.
+ * @param isAllCorrect Indicates if the game was won.
+ */
+void log_record_from_game(log_record* record, const game_session* session, User user, int isAllCorrect);
+
+/**
+ * @brief Copies a ring file record into a game of the history.
+ * @param record Pointer to the log_record struct to copy.
+ * @param entry Pointer to the game_entry struct to fill.
+ */
+void log_record_to_entry(const log_record* record, game_entry* entry);
+
+/**
+ * @brief Unit test function to enter and print user's request.
+ *
+ * This function tests the `enter_request` function by prompting the user to enter a request,
+ * storing it in a static array, and then printing the entered request to verify its correctness.
+ *
+ * The function clears the request buffer, invokes the `enter_request` function to accept user input,
+ * and then prints the request to the console for verification.
+ *
+ * @note The `enter_request` function should take a char array as input and populate it with the user's request.
+ */
+void ut_enter_request(void); 
+
+/**
+ * @brief Unit test function to input and validate user's name.
+ *
+ * This function tests the `input_user_name` function by prompting the user to enter a name,
+ * storing it in a User struct, and then printing the validation results.
+ *
+ * The function clears the user name buffer, invokes the `input_user_name` function to accept user input,
+ * checks if the input is valid and if the string length is within the maximum allowed length,
+ * and then prints the validation results to the console for verification.
+ *
+ * @note The `input_user_name` function should take a User struct pointer as input and populate it with the user's name.
+ */
+void ut_input_user_name(void); 
+
+/**
+ * @brief Unit test function to generate and print a random 6-digit number.
+ *
+ * This function tests the `random_6_digits_number` function by generating a random 6-digit number,
+ * storing it in a static character array, and then printing the generated number to verify its correctness.
+ *
+ * The function invokes the `random_6_digits_number` function to generate the random number
+ * of a local session, copies the magic number to a local variable for printing.
+ *
+ * @note The `random_6_digits_number` function should generate a 6-digit number and store it in the session `magicNumber`.
+ */
+void ut_random_6_digits_number(void);
+
+/**
+ * @brief Unit test function to input and validate a 6-digit number.
+ *
+ * This function tests the `input_6_digits_number` function by prompting the user to input a 6-digit number,
+ * validating the input, and then printing the validation result to verify its correctness.
+ *
+ * The function invokes the `input_6_digits_number` function to accept and validate the user's input,
+ * prints whether the input was valid or if the game should stop.
+ *
+ * @note The `input_6_digits_number` function should validate a 6-digit number entered by the user and return:
+ *       1 if the input is valid,
+ *      -1 if the game should stop.
+ */
+void ut_input_6_digits_number(void);
+
+/**
+ * @brief Unit test function to compare two strings and print the results.
+ *
+ * This function tests the `compare_2_string` function by comparing a predefined magic number
+ * with different input numbers, storing the results, and then printing the comparison results to verify correctness.
+ *
+ * The function sets predefined values for the magic number and input number of a local session,
+ * invokes the `compare_2_string` function to compare these strings,
+ * prints the result indicating whether all numbers are guessed correctly,
+ * and the common characters between the strings.
+ * It then checks the scoring rules of `score_guess` on a table of match masks.
+ *
+ * @note The `compare_2_string` function should compare the session magic number (`magicNumber`) 
+ *       with the session input number (`inputNumber`) and return:
+ *       1 if all characters match,
+ *       0 otherwise.
+ */
+void ut_compare_2_string(void);
+
+/**
+ * @brief Unit test function to load, read, save, and print top player data from/to a file.
+ *
+ * This function tests the sequence of operations for managing top player data by performing the following steps:
+ * 1. Reading the player table from a file.
+ * 2. Printing the high scores.
+ * 3. Updating the player table with a new player's data.
+ * 4. Saving the updated player table back to the file.
+ * 5. Printing the high scores again to verify the update.
+ *
+ * The function initializes a `User` struct with a sample username, performs file operations
+ * using `read_player_table_from_file`, `print_high_score`, `update_player_table`, and `save_player_table_to_file`,
+ * and prints the high scores before and after updating to ensure the data is correctly managed.
+ *
+ * @note The `read_player_table_from_file` function should read player data from a file and populate the `player_table`.
+ * @note The `print_high_score` function should display the current high scores from the `player_table`.
+ * @note The `update_player_table` function should update the player table with the data from the `User` struct.
+ * @note The `save_player_table_to_file` function should save the updated player table back to the file.
+ */
+void ut_load_read_save_print_top_file(void);
+
+/**
+ * @brief Unit test for saving and reading data of file log.
+ *
+ * This function tests the `save_user_to_file` and `load_user_list_from_file` functions
+ * by loading a user list from a file, modifying a user's data, saving the data back to the file, 
+ * and then instructing the user to check the file for correctness.
+ * 
+ * @note the `save_user_to_file` functions should save the user to the file
+ * @note the `load_user_list_from_file` function should read users data from a file
+ */
+void ut_save_and_load_file(void);
+
+/**
+ * @brief Guesser keeping the revealed digits and trying random digits on the others.
+ *
+ * @param commonChar The chars revealed so far ('_' for an unknown position).
+ * @param guessCount The index of the guess being made (unused).
+ * @param guess Output buffer receiving the next guess.
+ * @param seed Random seed used by `rand_r`.
+ */
+void guesser_random(const char* commonChar, int guessCount, char* guess, unsigned int* seed);
+
+/**
+ * @brief Guesser keeping the revealed digits and sweeping 0..9 on the others.
+ *
+ * The n-th guess puts digit (n - 1) on every unknown position, so a game always
+ * ends in at most 10 guesses.
+ *
+ * @param commonChar The chars revealed so far ('_' for an unknown position).
+ * @param guessCount The index of the guess being made.
+ * @param guess Output buffer receiving the next guess.
+ * @param seed Random seed (unused).
+ */
+void guesser_sweep(const char* commonChar, int guessCount, char* guess, unsigned int* seed);
+
+/**
+ * @brief Reads the monotonic clock.
+ * @return double Current time in seconds.
+ */
+double get_time_seconds(void);
+
+/**
+ * @brief Runs the compare benchmark mode.
+ *
+ * Scores random (magic number, guess) pairs with the current per-call path
+ * (`compare_2_string` on a headless session), with the packed compare of every digit
+ * kernel and with every batch compare kernel
+ * supported by the CPU, checks the kernels agree, and reports ns/pair and speedups.
+ *
+ * Usage: --bench-compare [pairs] [rounds]
+ *
+ * @param argc Argument count of the program.
+ * @param argv Argument vector of the program.
+ * @return int Exit code of the program.
+ */
+int run_compare_benchmark(int argc, char* argv[]);
+
+/**
+ * @brief Runs the micro benchmark mode.
+ *
+ * Times the core functions (magic number, input check, compare, player table update,
+ * player table and log file save/load) after warmup samples. Every sample runs a batch of
+ * calls of one function; the report gives min/p50/p90/p99/max ns per call over the samples.
+ * The files are written in a scratch directory removed at the end.
+ *
+ * Usage: --bench [samples] [warmup samples]
+ *
+ * @param argc Argument count of the program.
+ * @param argv Argument vector of the program.
+ * @return int Exit code of the program.
+ */
+int run_micro_benchmark(int argc, char* argv[]);
+
+/**
+ * @brief Creates a scratch directory and makes it the working directory.
+ * @param directory Receives the path of the directory (SCRATCH_DIRECTORY_SIZE bytes).
+ * @param previousDirectory Receives the working directory to go back to.
+ * @param size The size of previousDirectory.
+ * @return int 1 on success, 0 on failure.
+ */
+int scratch_directory_enter(char* directory, char* previousDirectory, size_t size);
+
+/**
+ * @brief Removes the game files of a scratch directory, goes back to the previous directory
+ *        and removes the scratch directory.
+ * @param directory The path of the scratch directory.
+ * @param previousDirectory The working directory to go back to.
+ */
+void scratch_directory_leave(const char* directory, const char* previousDirectory);
+
+/**
+ * @brief Runs the test runner mode.
+ *
+ * Runs every test case without any console interaction: the console functions read
+ * scripted input, the sessions print to a captured buffer, the files are written in a
+ * scratch directory. Every case is timed and reported PASS/FAIL with its failed checks.
+ *
+ * Usage: --test [name filter]
+ *
+ * @param argc Argument count of the program.
+ * @param argv Argument vector of the program.
+ * @return int Exit code of the program (0 when every case passed, 1 otherwise).
+ */
+int run_tests(int argc, char* argv[]);
+
+/**
+ * @brief Plays the games of one simulation worker.
+ *
+ * @param arg Pointer to the simulation_worker struct (work in, result out).
+ * @return void* Always NULL.
+ */
+void* run_simulation_worker(void* arg);
+
+/**
+ * @brief Runs the headless batch simulation mode.
+ *
+ * Plays N games end-to-end without any console interaction: a headless session is stepped
+ * with `game_step` through the account, play and high score phases, the scripted guesser
+ * providing the guesses. The store lives in memory unless the log and player table files
+ * are enabled. Reports games/sec and guesses/sec.
+ *
+ * Games are split across worker threads, each one owning its own session. With the files enabled
+ * the workers share one store, saved by one writer like the clients of the server; otherwise every
+ * worker owns its history and player table in memory.
+ *
+ * Usage: --simulate <games> [--guesser sweep|random] [--threads n] [--log] [--history games] [--digits n] [--seed n]
+ *
+ * @param argc Argument count of the program.
+ * @param argv Argument vector of the program.
+ * @return int Exit code of the program (0 for success, 1 for invalid arguments).
+ */
+int run_simulation(int argc, char* argv[]);
+
+/**
+ * @brief Runs the multi-client game server mode.
+ *
+ * Accepts clients on a Unix or TCP socket and drives the menu/play/quit flow of every
+ * client with its own session stepped by `game_step`. Connections are multiplexed with epoll
+ * on a small number of threads; the store (history and player table) is shared by all clients.
+ *
+ * Usage: --server <unix:path|tcp:port> [--threads n] [--history games] [--digits n] [--seed n]
+ *
+ * @param argc Argument count of the program.
+ * @param argv Argument vector of the program.
+ * @return int Exit code of the program (0 for success, 1 for failure).
+ */
+int run_server(int argc, char* argv[]);
+
+/**
+ * @brief Opens the non-blocking listening socket of the server.
+ * @param address "unix:<path>" for a Unix socket or "tcp:<port>" for a TCP socket on all interfaces.
+ * @return int The listening file descriptor, or -1 on failure.
+ */
+int server_open_listener(const char* address);
+
+/**
+ * @brief Runs the event loop of one server thread.
+ * @param arg Pointer to the server_worker struct.
+ * @return void* Always NULL.
+ */
+void* run_server_worker(void* arg);
+
+/**
+ * @brief Accepts all pending clients and registers them to the epoll instance of the thread.
+ * @param worker Pointer to the server_worker struct of the calling thread.
+ */
+void server_accept_connections(server_worker* worker);
+
+/**
+ * @brief Reads the available input of a client and steps its session for every complete line.
+ * @param server Pointer to the game_server struct.
+ * @param connection Pointer to the server_connection struct.
+ */
+void server_handle_input(game_server* server, server_connection* connection);
+
+/**
+ * @brief Steps the session of a client for every complete line already read.
+ * @details Stops at a game whose record is not saved yet (commit mode): the session goes on
+ *          with the next lines once server_resume_commits finds its record saved.
+ * @param connection Pointer to the server_connection struct.
+ */
+void server_process_input(server_connection* connection);
+
+/**
+ * @brief Flushes the output of a client, closes it when it is done or failed, and registers
+ *        the events it waits for.
+ * @details A client waiting for its record gets no event but a hangup: its output is sent once
+ *          the record is saved.
+ * @param worker Pointer to the server_worker struct owning the connection.
+ * @param connection Pointer to the server_connection struct.
+ * @param isHangup Non-zero when the socket reported an error or a hangup.
+ * @return int 1 if the connection is still open, 0 if it was closed.
+ */
+int server_connection_update(server_worker* worker, server_connection* connection, int isHangup);
+
+/**
+ * @brief Wakes the worker threads after a batch of the writer (commit mode).
+ * @param context Pointer to the game_server struct.
+ */
+void server_commit_notify(void* context);
+
+/**
+ * @brief Goes on with the clients of a worker whose records are saved (commit mode).
+ * @details It may close clients, so it runs after the other events of an epoll_wait batch,
+ *          which could still point to them.
+ * @param worker Pointer to the server_worker struct.
+ */
+void server_resume_commits(server_worker* worker);
+
+/**
+ * @brief Output sink of a client session: appends the text to the output buffer of the client.
+ * @param context Pointer to the server_connection struct.
+ * @param text The text to append.
+ * @param length The length of the text.
+ */
+void server_connection_output(void* context, const char* text, size_t length);
+
+/**
+ * @brief Writes as much pending output of a client as the socket accepts.
+ * @param connection Pointer to the server_connection struct.
+ * @return int 1 if all output is written, 0 if output is still pending, -1 on error.
+ */
+int server_connection_flush(server_connection* connection);
+
+/**
+ * @brief Closes a client connection and removes it from the list of its worker.
+ * @details A game left in progress is saved to the log file like a "quit".
+ * @param worker Pointer to the server_worker struct owning the connection.
+ * @param connection Pointer to the server_connection struct.
+ */
+void server_connection_close(server_worker* worker, server_connection* connection);
+
+/**
+ * @brief Runs the load generator mode.
+ *
+ * Plays with many concurrent bot players, against the game engine in process (the bot
+ * sessions share one store and are stepped in turn) or against a server (one connection
+ * per bot, multiplexed with epoll). The bots read the answers of the game like a player:
+ * random guessers, solvers using the "Result" feedback and quitters exercising the resume
+ * path. Reports games/sec, requests/sec and the latency percentiles of every phase.
+ *
+ * Usage: --loadgen <bots 1..1000000> [--games n] [--mix random:solver:quitter] [--target engine|unix:path|tcp:[host:]port]
+ *        [--threads n] [--digits n] [--seed n] [--log] [--history games]
+ *
+ * @param argc Argument count of the program.
+ * @param argv Argument vector of the program.
+ * @return int Exit code of the program (0 for success, 1 for invalid arguments or failed bots).
+ */
+int run_loadgen(int argc, char* argv[]);
+
+/**
+ * @brief Runs the bots of one load generator thread.
+ * @param arg Pointer to the loadgen_worker struct.
+ * @return void* Always NULL.
+ */
+void* run_loadgen_worker(void* arg);
+
+/**************************************************************************************
+ *                                MAIN PROGRAM
+ **************************************************************************************/
+int main(int argc, char* argv[])
+{   
+    /*Headless batch simulation*/
+    if (argc > 1 && strcmp(argv[1], "--simulate") == 0)
+    {
+        return run_simulation(argc, argv);
+    }
+
+    /*Multi-client game server*/
+    if (argc > 1 && strcmp(argv[1], "--server") == 0)
+    {
+        return run_server(argc, argv);
+    }
+
+    /*Load generator with bot players*/
+    if (argc > 1 && strcmp(argv[1], "--loadgen") == 0)
+    {
+        return run_loadgen(argc, argv);
+    }
+
+    /*Compare kernels benchmark*/
+    if (argc > 1 && strcmp(argv[1], "--bench-compare") == 0)
+    {
+        return run_compare_benchmark(argc, argv);
+    }
+
+    /*Core functions micro benchmark*/
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        return run_micro_benchmark(argc, argv);
+    }
+
+    /*Scripted self-checking tests*/
+    if (argc > 1 && strcmp(argv[1], "--test") == 0)
+    {
+        return run_tests(argc, argv);
+    }
+
+    /*Startup time: from here until the saved state is loaded*/
+    double startTime = get_time_seconds();
+
+    /*Number of games kept in the history, digit count of the games*/
+    long historyCapacity = GAME_HISTORY_DEFAULT_CAPACITY;
+    int digitCount = LENGTH_NUMBER;
+    uint64_t seed = (uint64_t)time(NULL);
+    int isSeedValid = 1;
+    int isPlain = (getenv("NO_COLOR") != NULL);
+    int isStartupReported = 0;
+    int isPersistValid = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--plain") == 0)
+        {
+            isPlain = 1;
+        }
+        else if (strcmp(argv[i], "--startup") == 0)
+        {
+            isStartupReported = 1;
+        }
+        else if (parse_persist_option(argc, argv, &i, &isPersistValid))
+        {
+            continue;
+        }
+        else if (strcmp(argv[i], "--history") == 0 && i + 1 < argc)
+        {
+            historyCapacity = strtol(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--digits") == 0 && i + 1 < argc)
+        {
+            digitCount = parse_digit_count(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            isSeedValid = parse_seed(argv[++i], &seed);
+        }
+        else
+        {
+            historyCapacity = 0;
+            break;
+        }
+    }
+    if (historyCapacity <= 0 || historyCapacity > GAME_HISTORY_MAX_CAPACITY || digitCount == 0 || !isSeedValid || !isPersistValid)
+    {
+        fprintf(stderr, "Usage: %s [--history 1..%ld] [--digits %s] [--seed n] [--plain] [--startup] " PERSIST_USAGE "\n", argv[0], GAME_HISTORY_MAX_CAPACITY, DIGIT_COUNT_CHOICES);
+        return 1;
+    }
+
+    /****************************************
+    *           Clear varible               *
+    *****************************************/
+    /*Create a store instance (history + top players), saved to files*/
+    game_store store;
+    if (!game_store_init(&store, 1, (size_t)historyCapacity))
+    {
+        return 1;
+    }
+
+    /*The saved state is loaded once, nothing is written at startup*/
+    if (isStartupReported)
+    {
+        fprintf(stderr, "Startup         : %.3f ms (%zu games, %d players loaded)\n",
+                (get_time_seconds() - startTime) * 1e3, store.history.count, store.topPlayers.nodeCount);
+    }
+
+    /*Create a session instance printing to the terminal, one write per screen*/
+    static terminal_screen screen;
+    screen.fd = STDOUT_FILENO;
+
+    game_session session;
+    game_session_init(&session, seed);
+    session.store = &store;
+    session.output = terminal_screen_output;
+    session.outputContext = &screen;
+    session.isPlain = isPlain;
+    session.isAdminAllowed = 1;
+    session.isMagicShown = 1;
+    session.digitCount = digitCount;
+
+    /*One input line, in the buffer of the console reader*/
+    char* line = NULL;
+
+    /****************************************
+    *               PROGRAM                 *
+    *****************************************/
+    game_session_start(&session);
+
+    while (session.state != GAME_STATE_STOPPED)
+    {
+        /*The screen is complete when the session waits for input*/
+        terminal_screen_flush(&screen);
+
+        int status = terminal_read_line(&line);
+
+        /*End of input: save the game in progress and stop*/
+        if (status < 0)
+        {
+            game_session_abandon(&session);
+            break;
+        }
+
+        game_step(&session, (status == 1) ? line : NULL);
+    }
+
+    terminal_screen_flush(&screen);
+    game_store_close(&store);
+    return 0; 
+}
+
+/**************************************************************************************
+ *                             EXECUTION FUNCTION
+ **************************************************************************************/
+
+/**************************************************************************************
+ *                              GAME SESSION INIT
+ **************************************************************************************/
+void game_session_init(game_session* session, uint64_t seed)
+{
+    memset(session, 0, sizeof(*session));
+    rng_seed(&session->rng, seed);
+    session->digitCount = LENGTH_NUMBER;
+    session->digitKernel = digit_kernel_find(LENGTH_NUMBER);
+}
+
+/**************************************************************************************
+ *                              GAME HISTORY INIT
+ **************************************************************************************/
+int game_history_init(game_history* history, size_t capacity)
+{
+    history->entries = calloc(capacity, sizeof(game_entry));
+    history->capacity = capacity;
+    history->count = 0;
+    history->head = 0;
+
+    if (history->entries == NULL)
+    {
+        perror("Error allocating history");
+        return 0;
+    }
+
+    return 1;
+}
+
+/**************************************************************************************
+ *                              GAME HISTORY FREE
+ **************************************************************************************/
+void game_history_free(game_history* history)
+{
+    free(history->entries);
+    history->entries = NULL;
+    history->capacity = 0;
+    history->count = 0;
+    history->head = 0;
+}
+
+/**************************************************************************************
+ *                              GAME HISTORY CLEAR
+ **************************************************************************************/
+void game_history_clear(game_history* history)
+{
+    history->count = 0;
+    history->head = 0;
+}
+
+/**************************************************************************************
+ *                              GAME HISTORY PUSH
+ **************************************************************************************/
+game_entry* game_history_push(game_history* history)
+{
+    /*The slot of the next insert holds the oldest game once the history is full*/
+    game_entry* entry = &history->entries[history->head];
+
+    history->head = (history->head + 1) % history->capacity;
+    if (history->count < history->capacity)
+    {
+        history->count++;
+    }
+
+    return entry;
+}
+
+/**************************************************************************************
+ *                               GAME HISTORY AT
+ **************************************************************************************/
+const game_entry* game_history_at(const game_history* history, size_t index)
+{
+    if (index >= history->count)
+    {
+        return NULL;
+    }
+
+    return &history->entries[(history->head + history->capacity - 1 - index) % history->capacity];
+}
+
+/**************************************************************************************
+ *                              GAME HISTORY INSERT
+ **************************************************************************************/
+void game_history_insert(game_history* history, const game_session* session, User user, int isAllCorrect)
+{
+    /* Add the new user in place of the oldest one */ 
+    game_entry* entry = game_history_push(history);
+
+    entry->user = user;
+    entry->commonMask = session->commonMask;
+    entry->magicNumber = session->magicNumber;
+    entry->digitCount = session->digitKernel->digitCount;
+    entry->isAllCorrect = isAllCorrect; 
+}
+
+/**************************************************************************************
+ *                          GAME HISTORY FIND UNFINISHED
+ **************************************************************************************/
+long game_history_find_unfinished(const game_history* history, User user)
+{
+    /*Check incompleting game account, the newest game of the account decides*/
+    for (size_t i = 0; i < history->count; i++)
+    {
+        const game_entry* entry = game_history_at(history, i);
+
+        if (strcmp(entry->user.userName, user.userName) == 0)
+        {
+            return (entry->isAllCorrect == 0) ? (long)i : -1;
+        }
+    }
+
+    return -1; 
+}
+
+/**************************************************************************************
+ *                              GAME STORE INIT
+ **************************************************************************************/
+int game_store_init(game_store* store, int isPersistent, size_t historyCapacity)
+{
+    if (!player_table_init(&store->topPlayers))
+    {
+        return 0;
+    }
+    if (!game_history_init(&store->history, historyCapacity))
+    {
+        player_table_free(&store->topPlayers);
+        return 0;
+    }
+    pthread_mutex_init(&store->mutex, NULL);
+    store->isPersistent = isPersistent;
+    store->writer = NULL;
+
+    store->pending = &store->memoryPending;
+    if (!pending_index_open(store->pending, NULL))
+    {
+        game_history_free(&store->history);
+        player_table_free(&store->topPlayers);
+        return 0;
+    }
+
+    if (isPersistent)
+    {
+        /*Load the saved games once, all persistent stores share the index file*/
+        pthread_mutex_lock(&s_file_mutex);
+        log_ring_load(&store->history);
+
+        /*The index file gets the games saved after its last update, the sessions use a copy*/
+        if (s_pending_file_users == 0 &&
+            (!pending_index_open(&s_pending_file_index, PENDING_INDEX_FILE) || log_ring_replay_pending(&s_pending_file_index) < 0))
+        {
+            pending_index_close(&s_pending_file_index);
+            pthread_mutex_unlock(&s_file_mutex);
+            pending_index_close(store->pending);
+            game_history_free(&store->history);
+            player_table_free(&store->topPlayers);
+            return 0;
+        }
+        s_pending_file_users++;
+        pending_index_copy(store->pending, &s_pending_file_index);
+        pthread_mutex_unlock(&s_file_mutex);
+
+        /*Load the saved player table once, a text table of an older version is converted*/
+        if (access(PLAYER_FILE, F_OK) == 0)
+        {
+            read_player_table_from_file(&store->topPlayers);
+        }
+        else if (access("top_players.txt", F_OK) == 0 && import_player_table_from_text(&store->topPlayers))
+        {
+            save_player_table_to_file(&store->topPlayers);
+        }
+
+        /*Without a writer thread the sessions write the files themselves*/
+        store->writer = persist_writer_start(store);
+    }
+
+    return 1;
+}
+
+/**************************************************************************************
+ *                              GAME STORE CLOSE
+ **************************************************************************************/
+void game_store_close(game_store* store)
+{
+    /*Write the queued games and the last player table first*/
+    if (store->writer != NULL)
+    {
+        persist_writer_stop(store->writer);
+        store->writer = NULL;
+    }
+
+    /*Refresh the text exports of the log and the player table*/
+    if (store->isPersistent)
+    {
+        save_user_list_to_file(&store->history);
+        export_player_table_to_text(&store->topPlayers);
+    }
+
+    /*The index file is closed with its last store*/
+    if (store->isPersistent)
+    {
+        pthread_mutex_lock(&s_file_mutex);
+        if (--s_pending_file_users == 0)
+        {
+            pending_index_close(&s_pending_file_index);
+        }
+        pthread_mutex_unlock(&s_file_mutex);
+    }
+    pending_index_close(store->pending);
+
+    game_history_free(&store->history);
+    player_table_free(&store->topPlayers);
+    pthread_mutex_destroy(&store->mutex);
+}
+
+/**************************************************************************************
+ *                              SESSION PRINTF
+ **************************************************************************************/
+void session_printf(const game_session* session, const char* format, ...)
+{
+    /*Headless session: skip formatting entirely*/
+    if (session->output == NULL)
+    {
+        return;
+    }
+
+    char text[1024];
+    va_list arguments;
+
+    va_start(arguments, format);
+    int length = vsnprintf(text, sizeof(text), format, arguments);
+    va_end(arguments);
+
+    if (length < 0)
+    {
+        return;
+    }
+    if ((size_t)length >= sizeof(text))
+    {
+        length = sizeof(text) - 1;
+    }
+
+    session->output(session->outputContext, text, (size_t)length);
+}
+
+/**************************************************************************************
+ *                              TERMINAL OUTPUT
+ **************************************************************************************/
+void terminal_output(void* context, const char* text, size_t length)
+{
+    (void)context;
+    fwrite(text, 1, length, stdout);
+}
+
+/**************************************************************************************
+ *                              LINE READER INIT
+ **************************************************************************************/
+void line_reader_init(line_reader* reader, int fd, size_t maxLength)
+{
+    reader->fd = fd;
+    reader->maxLength = maxLength;
+    reader->start = 0;
+    reader->length = 0;
+    reader->isDiscarding = 0;
+    reader->isEof = 0;
+}
+
+/**************************************************************************************
+ *                              LINE READER FILL
+ **************************************************************************************/
+ssize_t line_reader_fill(line_reader* reader)
+{
+    /*Move the partial line to the front of the buffer*/
+    if (reader->start > 0)
+    {
+        memmove(reader->buffer, reader->buffer + reader->start, reader->length - reader->start);
+        reader->length -= reader->start;
+        reader->start = 0;
+    }
+
+    ssize_t received;
+    do
+    {
+        received = read(reader->fd, reader->buffer + reader->length, sizeof(reader->buffer) - reader->length);
+    } while (received < 0 && errno == EINTR);
+
+    if (received > 0)
+    {
+        reader->length += (size_t)received;
+    }
+    else if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+    {
+        reader->isEof = 1;
+    }
+
+    return received;
+}
+
+/**************************************************************************************
+ *                              LINE READER NEXT
+ **************************************************************************************/
+int line_reader_next(line_reader* reader, char** line)
+{
+    char* begin = reader->buffer + reader->start;
+    size_t available = reader->length - reader->start;
+    char* end = memchr(begin, '\n', available);
+    size_t lineLength;
+
+    if (end != NULL)
+    {
+        lineLength = (size_t)(end - begin);
+        reader->start += lineLength + 1;
+    }
+    else if (reader->isDiscarding || available > reader->maxLength + 1)
+    {
+        /*Overlong partial line: drop it, the rest is discarded up to the newline char*/
+        reader->isDiscarding = !reader->isEof;
+        reader->start = reader->length = 0;
+        return reader->isEof ? 0 : -2;
+    }
+    else if (!reader->isEof)
+    {
+        return -2;
+    }
+    else if (available == 0)
+    {
+        return -1;
+    }
+    else
+    {
+        /*End of input: the last line has no newline char, make room for its null terminator*/
+        memmove(reader->buffer, begin, available);
+        begin = reader->buffer;
+        lineLength = available;
+        reader->start = reader->length = 0;
+    }
+
+    /*End of an overlong line*/
+    if (reader->isDiscarding)
+    {
+        reader->isDiscarding = 0;
+        return 0;
+    }
+
+    /*Drop the carriage return of telnet-like clients*/
+    if (lineLength > 0 && begin[lineLength - 1] == '\r')
+    {
+        lineLength--;
+    }
+    if (lineLength > reader->maxLength)
+    {
+        return 0;
+    }
+
+    begin[lineLength] = '\0';
+    *line = begin;
+    return 1;
+}
+
+/**************************************************************************************
+ *                              LINE READER READ
+ **************************************************************************************/
+int line_reader_read(line_reader* reader, char** line)
+{
+    for (;;)
+    {
+        int status = line_reader_next(reader, line);
+        if (status != -2)
+        {
+            return status;
+        }
+
+        /*Read errors end the input like the end of file*/
+        line_reader_fill(reader);
+    }
+}
+
+/**************************************************************************************
+ *                              TERMINAL WRITE
+ **************************************************************************************/
+static void terminal_write(int fd, const char* text, size_t length)
+{
+    /*Pending stdio output goes first (unit test menu)*/
+    fflush(stdout);
+
+    size_t offset = 0;
+    while (offset < length)
+    {
+        ssize_t written = write(fd, text + offset, length - offset);
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            perror("Error writing screen");
+            return;
+        }
+        offset += (size_t)written;
+    }
+}
+
+/**************************************************************************************
+ *                           TERMINAL SCREEN OUTPUT
+ **************************************************************************************/
+void terminal_screen_output(void* context, const char* text, size_t length)
+{
+    terminal_screen* screen = (terminal_screen*)context;
+
+    if (length > sizeof(screen->text) - screen->length)
+    {
+        terminal_screen_flush(screen);
+    }
+
+    /*Text larger than the whole buffer: write it at once*/
+    if (length > sizeof(screen->text))
+    {
+        terminal_write(screen->fd, text, length);
+        return;
+    }
+
+    memcpy(screen->text + screen->length, text, length);
+    screen->length += length;
+}
+
+/**************************************************************************************
+ *                           TERMINAL SCREEN FLUSH
+ **************************************************************************************/
+void terminal_screen_flush(terminal_screen* screen)
+{
+    if (screen->length == 0)
+    {
+        return;
+    }
+
+    terminal_write(screen->fd, screen->text, screen->length);
+    screen->length = 0;
+}
+
+/**************************************************************************************
+ *                              TERMINAL READ LINE
+ **************************************************************************************/
+int terminal_read_line(char** line)
+{
+    fflush(stdout);
+    return line_reader_read(&s_console_reader, line);
+}
+
+/**************************************************************************************
+ *                              GAME ENTER MENU
+ **************************************************************************************/
+static void game_enter_menu(game_session* session)
+{
+    /*Check admin account*/
+    session->isAdmin = session->isAdminAllowed && (strcmp(session->user.userName, "nhathanh") == 0);
+
+    /*Print interface game*/
+    printf_interface(session);
+    session_printf(session, "Enter your request: ");
+
+    session->state = GAME_STATE_MENU;
+}
+
+/**************************************************************************************
+ *                              GAME PROMPT GUESS
+ **************************************************************************************/
+static void game_prompt_guess(game_session* session)
+{
+    /*Increase guess count*/
+    session->user.totalGuess++;
+
+    session_printf(session, "%d.Enter the number(quit for stop game): ", session->user.totalGuess);
+}
+
+/**************************************************************************************
+ *                            GAME PRINT NOT SAVED
+ **************************************************************************************/
+static void game_print_not_saved(game_session* session)
+{
+    session_printf(session, "%sThe game could not be saved\n%s", SESSION_COLOR(session, RED), SESSION_COLOR(session, RESET));
+}
+
+/**************************************************************************************
+ *                              GAME RECORD
+ **************************************************************************************/
+static void game_record(game_session* session, int isAllCorrect)
+{
+    game_store* store = session->store;
+    log_record record;
+
+    pthread_mutex_lock(&store->mutex);
+
+    /*Game end: update the player table*/
+    if (isAllCorrect)
+    {
+        update_player_table(&session->user, &store->topPlayers);
+        if (store->isPersistent && store->writer == NULL)
+        {
+            save_player_table_to_file(&store->topPlayers);
+        }
+    }
+
+    /*Save to log file (and to the index file), by the writer thread when the store has one*/
+    if (store->writer != NULL)
+    {
+        game_history_insert(&store->history, session, session->user, isAllCorrect);
+        log_record_from_game(&record, session, session->user, isAllCorrect);
+    }
+    else if (store->isPersistent)
+    {
+        save_user_to_file(&store->history, session, session->user, isAllCorrect);
+    }
+    else
+    {
+        game_history_insert(&store->history, session, session->user, isAllCorrect);
+    }
+
+    /*Keep the unfinished game of the account, a won game has nothing to resume*/
+    if (isAllCorrect)
+    {
+        pending_index_remove(store->pending, session->user.userName);
+    }
+    else
+    {
+        pending_index_put(store->pending, session->user, &session->magicNumber, session->commonMask, session->digitKernel->digitCount);
+    }
+
+    pthread_mutex_unlock(&store->mutex);
+
+    /*Queue it once the store is free, a full queue waits for the writer*/
+    if (store->writer != NULL)
+    {
+        uint64_t ticket = persist_writer_push(store->writer, &record, isAllCorrect);
+
+        /*Commit mode: the game goes on once its record is synced, a front end which must not
+          block holds the session itself*/
+        if (store->writer->options.mode == PERSIST_SYNC_COMMIT)
+        {
+            if (session->isCommitDeferred)
+            {
+                session->commitTicket = ticket;
+            }
+            else if (!persist_writer_wait(store->writer, ticket))
+            {
+                game_print_not_saved(session);
+            }
+        }
+    }
+}
+
+/**************************************************************************************
+ *                              GAME START PLAY
+ **************************************************************************************/
+static void game_start_play(game_session* session)
+{
+    game_store* store = session->store;
+    User* user = &session->user;
+
+    /*Check user has account yet*/
+    if (strlen(user->userName) == 0)
+    {
+        session_printf(session, "You dont't have account.Cannot start the game\n");
+        game_enter_menu(session);
+        return;
+    }
+
+    /*Clear for new game*/
+    user->totalGuess = 0;
+    user->rightGuess = 0;
+    user->timeRecord = 0.0f;
+
+    /*Create magic number with the digit count of the new games*/
+    session->digitKernel = digit_kernel_find(session->digitCount);
+    random_6_digits_number(session);
+
+    /*clear common digits*/
+    session->commonMask = 0;
+
+    /*Look up the unfinished game of user_name*/
+    pthread_mutex_lock(&store->mutex);
+
+    const pending_slot* pending = pending_index_find(store->pending, user->userName);
+    const digit_kernel* pendingKernel = (pending != NULL) ? digit_kernel_find(pending->digitCount) : NULL;
+
+    /*Update data of last play if the account had not finished it, with its digit count*/
+    if (pendingKernel != NULL)
+    {
+        user->totalGuess = pending->totalGuess - 1;
+        user->rightGuess = pending->rightGuess;
+        user->timeRecord = pending->timeRecord;
+        session->digitKernel = pendingKernel;
+        session->magicNumber = pending->magicNumber;
+        session->commonMask = pending->commonMask;
+        session_printf(session, "Your account had not finnished the last game yet.\n");
+    }
+
+    pthread_mutex_unlock(&store->mutex);
+
+    session_printf(session, "%s\n                                                    GAME START\n%s", SESSION_COLOR(session, GREEN), SESSION_COLOR(session, RESET));
+
+    /*Print for fast checking*/
+    if (session->isMagicShown)
+    {
+        char magicText[LENGTH_NUMBER_MAX + 1];
+        session_printf(session, "%s\n", packed_digits_format(&session->magicNumber, DIGIT_MASK_ALL(session->digitKernel->digitCount),
+                                                             session->digitKernel->digitCount, magicText));
+    }
+
+    /*Capture start time*/
+    session->startTime = time(NULL);
+
+    game_prompt_guess(session);
+    session->state = GAME_STATE_PLAY;
+}
+
+/**************************************************************************************
+ *                              GAME FINISH PLAY
+ **************************************************************************************/
+static void game_finish_play(game_session* session)
+{
+    /*Capture end guessing action */
+    session->user.timeRecord += difftime(time(NULL), session->startTime);
+
+    /*Update the player table, save it and the log file*/
+    game_record(session, 1);
+
+    /*Rank of the player among all players (skipped by a headless session)*/
+    if (session->output != NULL)
+    {
+        pthread_mutex_lock(&session->store->mutex);
+        print_player_rank(session, &session->store->topPlayers, session->user.userName);
+        pthread_mutex_unlock(&session->store->mutex);
+    }
+
+    if (!session->isPlain)
+    {
+        session_printf(session, "\n                                 /\\_/\\  (   \n");
+        session_printf(session, "                                ( ^.^ ) _)  \n");
+        session_printf(session, "                                  \"/  (    \n");
+        session_printf(session, "                                ( | | )     \n");
+        session_printf(session, "                               (__d b__)    ");
+    }
+
+    session_printf(session, "CONGRATULATION!\n");
+    session_printf(session, "                         Do you want to see the 10 highest table(y/Y. YES n/N. No): ");
+
+    session->state = GAME_STATE_HIGH_SCORE;
+}
+
+/**************************************************************************************
+ *                              GAME RUN ADMIN REQUEST
+ **************************************************************************************/
+static void game_run_admin_request(game_session* session, char request)
+{
+    switch (request)
+    {
+    case '1':
+        ut_enter_request();
+        break;
+    case '2':
+        ut_input_user_name();
+        break;
+    case '3':
+        ut_random_6_digits_number();
+        break;
+    case '4':
+        ut_input_6_digits_number();
+        break;
+    case '5':
+        ut_compare_2_string();
+        break;
+    case '6':
+        ut_load_read_save_print_top_file();
+        break;
+    case '7':
+        ut_save_and_load_file();
+        break;
+    case '8':
+        memset(session->user.userName, '\0', sizeof(session->user.userName));
+        break;
+    default:
+        session->state = GAME_STATE_STOPPED;
+        return;
+    }
+
+    game_enter_menu(session);
+}
+
+/**************************************************************************************
+ *                              GAME SESSION START
+ **************************************************************************************/
+void game_session_start(game_session* session)
+{
+    game_enter_menu(session);
+}
+
+/**************************************************************************************
+ *                                 GAME STEP
+ **************************************************************************************/
+void game_step(game_session* session, const char* line)
+{
+    /*An overlong line is never a valid input*/
+    int isOverlong = (line == NULL);
+    if (isOverlong)
+    {
+        line = "";
+    }
+
+    switch (session->state)
+    {
+    case GAME_STATE_MENU:
+    {
+        if (!check_request(line, session->isAdmin))
+        {
+            session_printf(session, "%sInvalid request\n%sEnter your request: ", SESSION_COLOR(session, RED), SESSION_COLOR(session, RESET));
+            break;
+        }
+
+        if (session->isAdmin)
+        {
+            game_run_admin_request(session, line[0]);
+            break;
+        }
+
+        switch (line[0])
+        {
+        /*Create account*/
+        case '1':
+            session_printf(session, "User name: ");
+            session->state = GAME_STATE_USER_NAME;
+            break;
+
+        /*Start game*/
+        case '2':
+            game_start_play(session);
+            break;
+
+        /*Exit*/
+        default:
+            session->state = GAME_STATE_STOPPED;
+            break;
+        }
+        break;
+    }
+
+    case GAME_STATE_USER_NAME:
+    {
+        if (isOverlong || !check_user_name(line))
+        {
+            session_printf(session, "%sUser name is not valid\nPlease enter the user name again\n%sUser name: ", SESSION_COLOR(session, RED), SESSION_COLOR(session, RESET));
+            break;
+        }
+
+        strcpy(session->user.userName, line);
+        game_enter_menu(session);
+        break;
+    }
+
+    case GAME_STATE_PLAY:
+    {
+        int isValid = check_6_digits_number(line, session->digitKernel);
+
+        if (isValid == 0)
+        {
+            session_printf(session, "%sInput number invalid\n%sEnter the number(quit for stop game): ", SESSION_COLOR(session, RED), SESSION_COLOR(session, RESET));
+            break;
+        }
+
+        /*User entered "quit"*/
+        if (isValid == -1)
+        {
+            /*Capture end guessing action, save to log file*/
+            session->user.timeRecord = difftime(time(NULL), session->startTime);
+            game_record(session, 0);
+            game_enter_menu(session);
+            break;
+        }
+
+        /*Compare*/
+        session->digitKernel->parse(line, &session->inputNumber);
+        if (compare_2_string(session, &session->user))
+        {
+            game_finish_play(session);
+        }
+        else
+        {
+            game_prompt_guess(session);
+        }
+        break;
+    }
+
+    case GAME_STATE_HIGH_SCORE:
+    {
+        /* Check for valid input (y/Y or n/N)*/
+        if (line[0] == 'y' || line[0] == 'Y')
+        {
+            pthread_mutex_lock(&session->store->mutex);
+            print_high_score(session, &session->store->topPlayers);
+            print_player_neighbors(session, &session->store->topPlayers, session->user.userName);
+            pthread_mutex_unlock(&session->store->mutex);
+        }
+        else if (line[0] != 'n' && line[0] != 'N')
+        {
+            session_printf(session, "%s                         Invalid input. Please enter y/Y for YES or n/N for NO: %s", SESSION_COLOR(session, RED), SESSION_COLOR(session, RESET));
+            break;
+        }
+
+        /*Clear all variables of struct for new player*/
+        memset(&session->user, 0, sizeof(session->user));
+        game_enter_menu(session);
+        break;
+    }
+
+    case GAME_STATE_STOPPED:
+    default:
+        break;
+    }
+}
+
+/**************************************************************************************
+ *                            GAME SESSION ABANDON
+ **************************************************************************************/
+void game_session_abandon(game_session* session)
+{
+    /*Save the game left in progress like a "quit"*/
+    if (session->state == GAME_STATE_PLAY)
+    {
+        session->user.timeRecord = difftime(time(NULL), session->startTime);
+        game_record(session, 0);
+    }
+
+    session->state = GAME_STATE_STOPPED;
+}
+
+/**************************************************************************************
+ *                          GAME SESSION COMMIT POLL
+ **************************************************************************************/
+int game_session_commit_poll(game_session* session)
+{
+    if (session->commitTicket == 0)
+    {
+        return 1;
+    }
+
+    int status = persist_writer_check(session->store->writer, session->commitTicket);
+    if (status < 0)
+    {
+        return 0;
+    }
+
+    if (status == 0)
+    {
+        game_print_not_saved(session);
+    }
+    session->commitTicket = 0;
+    return 1;
+}
+
+/**************************************************************************************
+ *                              PRINT_INTERFACE
+ **************************************************************************************/
+void printf_interface(const game_session* session)
+{
+    if (!session->isPlain)
+    {
+        session_printf(session, BLUE"                                  ___  __  __  ____  ___     ___    __    __  __  ____ \n" RESET);
+        session_printf(session, GREEN"                                 / __)(  )(  )( ___)/ __)   / __)  /__\\  (  \\/  )( ___)\n" RESET);
+        session_printf(session, YELLOW"                                ( (_-. )(__)(  )__) \\__\\   ( (_-. /(__)\\  )    (  )__) \n" RESET);
+        session_printf(session, RED"                                 \\___/(______)(____)(___/   \\___/(__)(__)(_/\\/\\_)(____)\n\n" RESET);
+    }
+
+    session_printf(session, "                                        Welcome to Gues Game by tranquangnguyenanh.\n\n");
+
+    if(session->isAdmin)
+    {
+        session_printf(session, "\n                                            UNIT TEST FOR ADMIN\n");
+        session_printf(session, "                                        1. UT_ENTER_REQUEST\n");
+        session_printf(session, "                                        2. UT_INPUT_USER_NAME\n");
+        session_printf(session, "                                        3. UT_RANDOM_6_DIGITS_NUMBER\n"); 
+        session_printf(session, "                                        4. UT_INPUT_6_DIGITS_NUMBER\n");
+        session_printf(session, "                                        5. UT_COMPARE_2_STRING\n");
+        session_printf(session, "                                        6. UT_INTERRACT_WITH_TOP_PLAYER_FILE\n");
+        session_printf(session, "                                        7. UT_INTERRACT_WITH_LOG_FILE\n");
+        session_printf(session, "                                        8. EXIT\n");
+        session_printf(session, "                                        9. STOP PROGRAM\n"); 
+    }
+    else
+    {
+        session_printf(session, "                                                        MENU\n");
+        session_printf(session, "                                                1. CREATE ACCOUNT\n");
+        session_printf(session, "                                                2.      PLAY\n");
+        session_printf(session, "                                                3.      EXIT\n"); 
+    }
+}
+
+/**************************************************************************************
+ *                              CHECK_REQUEST
+ **************************************************************************************/
+int check_request(const char* userRequest, int isAdmin)
+{
+    char maxRequest = isAdmin ? '9' : '3';
+
+    return (strlen(userRequest) == 1 && userRequest[0] >= '1' && userRequest[0] <= maxRequest);
+}
+
+/**************************************************************************************
+ *                              CHECK_USER_NAME
+ **************************************************************************************/
+int check_user_name(const char* userName)
+{
+    /*Check length of user name*/
+    if (strlen(userName) > LENGTH_STRING_MAX)
+    {
+        return 0;
+    }
+
+    /*Check the string user_name is valid*/
+    for (int i = 0; userName[i] != '\0'; i++)
+    {
+        if (!isalnum((unsigned char)userName[i]))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**************************************************************************************
+ *                           CHECK_6_DIGITS_NUMBER
+ **************************************************************************************/
+int check_6_digits_number(const char* inputNumber, const digit_kernel* kernel)
+{
+    /* Check if the user wants to quit */
+    if (strcmp(inputNumber, "quit") == 0)
+    {
+        return -1;
+    }
+
+    /*Check length of string and numeric elements*/
+    return kernel->check(inputNumber);
+}
+
+/**************************************************************************************
+ *                              ENTER_REQUEST
+ **************************************************************************************/
+void enter_request(const game_session* session, char userRequest[3])
+{
+    int isValid  = 0; 
+    do
+    {
+        /* Clear request */
+        memset(userRequest,'\0', 3);
+
+        /* Enter request */
+        printf("Enter your request: ");
+        char* line;
+        int status = terminal_read_line(&line);
+
+        /* End of input: no request */
+        if (status < 0)
+        {
+            break;
+        }
+
+        /* Validate input (an overlong line is never valid) */
+        if (status == 1 && check_request(line, session->isAdmin))
+        {
+            strcpy(userRequest, line);
+            isValid = 1;
+        }
+        else
+        {
+            printf(RED"Invalid request\n"RESET);
+        }
+    } while (isValid == 0);
+}
+
+/**************************************************************************************
+ *                              INPUT_USER_NAME
+ **************************************************************************************/
+int input_user_name(User* user)
+{
+    /*Check String is valid or invalid*/
+    /*1: valid  ; 0: invalid*/
+    int isValid = 0;
+
+    /*Print request*/
+    printf("User name: ");
+
+    /*Clear string before type*/
+    memset(user->userName, '\0', sizeof(user->userName));
+
+    /*Input string*/
+    char* line;
+    int status = terminal_read_line(&line);
+    if (status >= 0)
+    {
+        /*Keep what fits in the user name, an overlong line is too long anyway*/
+        if (status == 1)
+        {
+            snprintf(user->userName, sizeof(user->userName), "%.*s", (int)sizeof(user->userName) - 1, line);
+        }
+
+        /*Check length of user name*/
+        if (status == 0 || strlen(line) > LENGTH_STRING_MAX)
+        {
+            isValid = 0;
+            printf(RED "The length exceeds the allowed maximum of %d characters.\n" RESET, LENGTH_STRING_MAX);
+        }
+        else
+        {
+            /*Check the string user_name is valid*/
+            isValid = check_user_name(user->userName);
+        }
+
+        /*Double check*/
+        if (isValid)
+        {
+           /*Finish the task*/
+        }
+        else
+        {
+            printf(RED"User name is not valid\nPlease enter the user name again\n"RESET); 
+        }
+    }
+    else 
+    {}
+
+    return isValid; 
+}
+
+/**************************************************************************************
+ *                            RANDOM_6_DIGIT_NUMBER
+ **************************************************************************************/
+void random_6_digits_number(game_session* session)
+{
+    /*Create magic number from the session generator*/
+    session->digitKernel->random(&session->magicNumber, &session->rng);
+}
+
+/**************************************************************************************
+ *                            INPUT_6_DIGIT_NUMBER
+ **************************************************************************************/
+int input_6_digits_number(game_session* session)
+{
+    /*Check String is valid or invalid*/
+    /*1: valid  ; 0: invalid*/
+    int isValid = 0;
+
+    /*Print request*/
+    printf("Enter the number(quit for stop game): "); 
+
+    /*Enter 6 digit number*/
+    char* line;
+    int status = terminal_read_line(&line);
+
+    /*End of input stops the game like "quit"*/
+    if (status < 0)
+    {
+        return -1;
+    }
+
+    /* Check quit request, length and numeric elements (-1 indicates "quit"), an overlong line is invalid */
+    if (status == 1)
+    {
+        isValid = check_6_digits_number(line, session->digitKernel);
+    }
+
+    if (isValid == 1)
+    {
+        session->digitKernel->parse(line, &session->inputNumber);
+    }
+    else if (isValid == 0)
+    {
+        printf(RED"Input number invalid\n"RESET);
+    }
+    
+    return isValid;
+}
+
+/**************************************************************************************
+ *                              COMPARE_2_STRING
+ **************************************************************************************/
+int compare_2_string(game_session* session, User* user)
+{
+    const digit_kernel* kernel = session->digitKernel;
+
+    /* Compare all digits at once and score the guess */
+    digit_mask matchMask = kernel->match(&session->magicNumber, &session->inputNumber);
+    guess_score score = score_guess(session->commonMask, matchMask, kernel->digitCount, user->rightGuess);
+
+    /* Update the right guesses and the common digits with new correct guesses */
+    user->rightGuess = score.rightGuess;
+    session->commonMask = score.commonMask;
+
+    /* Print check */
+    char commonText[LENGTH_NUMBER_MAX + 1];
+    session_printf(session, "Result: %s\n", packed_digits_format(&session->magicNumber, session->commonMask, kernel->digitCount, commonText));
+    session_printf(session, "Right Guesses: %d\n", user->rightGuess);
+
+    return score.isAllCorrect; 
+}
+
+/**************************************************************************************
+ *                                 SCORE GUESS
+ **************************************************************************************/
+guess_score score_guess(digit_mask commonMask, digit_mask matchMask, int digitCount, int32_t rightGuess)
+{
+    digit_mask allMask = DIGIT_MASK_ALL(digitCount);
+    guess_score score;
+
+    score.commonMask = matchMask;
+    score.newCorrectCount = (uint8_t)__builtin_popcountll(matchMask & ~commonMask & allMask);
+    score.lostCount = (uint8_t)__builtin_popcountll(commonMask & ~matchMask & allMask);
+    score.isAllCorrect = (matchMask == allMask);
+
+    /*One more right guess for new digits only, one less for lost digits only*/
+    score.rightGuess = rightGuess + (score.newCorrectCount != 0 && score.lostCount == 0)
+                                  - (score.lostCount != 0 && score.newCorrectCount == 0);
+
+    /*Make sure that Rightguess >= 0*/
+    if (score.rightGuess < 0)
+    {
+        score.rightGuess = 0;
+    }
+
+    return score;
+}
+
+/**************************************************************************************
+ *                                  RNG SEED
+ **************************************************************************************/
+void rng_seed(rng_state* rng, uint64_t seed)
+{
+    /*splitmix64 sequence, never gives the all zero state*/
+    for (int i = 0; i < 4; i++)
+    {
+        uint64_t value = (seed += 0x9E3779B97F4A7C15ull);
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        rng->state[i] = value ^ (value >> 31);
+    }
+}
+
+/**************************************************************************************
+ *                                  RNG NEXT
+ **************************************************************************************/
+uint64_t rng_next(rng_state* rng)
+{
+    uint64_t* s = rng->state;
+    uint64_t result = s[1] * 5;
+    result = ((result << 7) | (result >> 57)) * 9;
+
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+
+    return result;
+}
+
+/**************************************************************************************
+ *                                  RNG JUMP
+ **************************************************************************************/
+void rng_jump(rng_state* rng)
+{
+    /*Jump polynomial of xoshiro256 for 2^128 draws*/
+    static const uint64_t jump[4] = { 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull };
+    uint64_t state[4] = { 0, 0, 0, 0 };
+
+    for (int i = 0; i < 4; i++)
+    {
+        for (int b = 0; b < 64; b++)
+        {
+            if (jump[i] & ((uint64_t)1 << b))
+            {
+                for (int w = 0; w < 4; w++)
+                {
+                    state[w] ^= rng->state[w];
+                }
+            }
+            rng_next(rng);
+        }
+    }
+
+    memcpy(rng->state, state, sizeof(state));
+}
+
+/**************************************************************************************
+ *                                 PARSE SEED
+ **************************************************************************************/
+int parse_seed(const char* text, uint64_t* seed)
+{
+    char* end = NULL;
+
+    errno = 0;
+    *seed = strtoull(text, &end, 0);
+
+    return errno == 0 && end != text && *end == '\0';
+}
+
+/**************************************************************************************
+ *                             PACKED DIGITS FORMAT
+ **************************************************************************************/
+char* packed_digits_format(const packed_digits* digits, digit_mask mask, int digitCount, char* text)
+{
+    for (int i = 0; i < digitCount; i++)
+    {
+        unsigned int digit = (unsigned int)(digits->words[i / 16] >> (4 * (i % 16))) & 0xF;
+        text[i] = (mask & ((digit_mask)1 << i)) ? (char)('0' + digit) : '_';
+    }
+    text[digitCount] = '\0';
+
+    return text;
+}
+
+/**************************************************************************************
+ *                             PACKED WORD MATCH
+ **************************************************************************************/
+digit_mask packed_word_match(uint64_t magicWord, uint64_t inputWord)
+{
+    /*A digit differs when any bit of its nibble differs, fold the nibble into its low bit*/
+    uint64_t diff = magicWord ^ inputWord;
+    diff |= diff >> 1;
+    diff |= diff >> 2;
+
+    /*Low bit of every equal digit, then gather bit 4*i into bit i*/
+    uint64_t match = ~diff & 0x1111111111111111ull;
+    match = (match | (match >> 3)) & 0x0303030303030303ull;
+    match = (match | (match >> 6)) & 0x000F000F000F000Full;
+    match = (match | (match >> 12)) & 0x000000FF000000FFull;
+    match = (match | (match >> 24)) & 0x000000000000FFFFull;
+
+    return match;
+}
+
+/**
+ * @def DIGIT_KERNEL_DEFINE
+ * @brief Defines the check, parse, random and match functions of the `count` digit kernel.
+ * @details `count` is a constant in every loop, so the 6-digit functions are as short as
+ *          hand-written ones (one packed word) and the longer ones are unrolled/vectorized.
+ */
+#define DIGIT_KERNEL_DEFINE(count)                                                          \
+static int check_digits_##count(const char* text)                                           \
+{                                                                                           \
+    for (int i = 0; i < (count); i++)                                                       \
+    {                                                                                       \
+        if (text[i] < '0' || text[i] > '9')                                                 \
+        {                                                                                   \
+            return 0;                                                                       \
+        }                                                                                   \
+    }                                                                                       \
+    return text[(count)] == '\0';                                                           \
+}                                                                                           \
+                                                                                            \
+static void parse_digits_##count(const char* text, packed_digits* digits)                   \
+{                                                                                           \
+    memset(digits, 0, sizeof(*digits));                                                     \
+    for (int i = 0; i < (count); i++)                                                       \
+    {                                                                                       \
+        digits->words[i / 16] |= (uint64_t)(text[i] - '0') << (4 * (i % 16));               \
+    }                                                                                       \
+}                                                                                           \
+                                                                                            \
+static void random_digits_##count(packed_digits* digits, rng_state* rng)                    \
+{                                                                                           \
+    /*The draw is a fraction of 2^64, every digit is the integer part of fraction * 10*/    \
+    uint64_t fraction = 0;                                                                  \
+    memset(digits, 0, sizeof(*digits));                                                     \
+    for (int i = 0; i < (count); i++)                                                       \
+    {                                                                                       \
+        if (i % 16 == 0)                                                                    \
+        {                                                                                   \
+            fraction = rng_next(rng);                                                       \
+        }                                                                                   \
+        unsigned __int128 product = (unsigned __int128)fraction * 10;                       \
+        fraction = (uint64_t)product;                                                       \
+        digits->words[i / 16] |= (uint64_t)(product >> 64) << (4 * (i % 16));               \
+    }                                                                                       \
+}                                                                                           \
+                                                                                            \
+static digit_mask match_digits_##count(const packed_digits* magicNumber, const packed_digits* inputNumber) \
+{                                                                                           \
+    digit_mask mask = 0;                                                                    \
+    for (int w = 0; w < ((count) + 15) / 16; w++)                                           \
+    {                                                                                       \
+        mask |= packed_word_match(magicNumber->words[w], inputNumber->words[w]) << (16 * w); \
+    }                                                                                       \
+    return mask & DIGIT_MASK_ALL(count);                                                    \
+}
+
+/**
+ * @def DIGIT_KERNEL
+ * @brief Initializer of the digit_kernel struct defined by `DIGIT_KERNEL_DEFINE(count)`.
+ */
+#define DIGIT_KERNEL(count)  { (count), check_digits_##count, parse_digits_##count, random_digits_##count, match_digits_##count }
+
+DIGIT_KERNEL_DEFINE(6)
+DIGIT_KERNEL_DEFINE(8)
+DIGIT_KERNEL_DEFINE(12)
+DIGIT_KERNEL_DEFINE(16)
+DIGIT_KERNEL_DEFINE(24)
+DIGIT_KERNEL_DEFINE(32)
+DIGIT_KERNEL_DEFINE(48)
+DIGIT_KERNEL_DEFINE(64)
+
+/*Digit kernels, one per DIGIT_COUNT_CHOICES value (LENGTH_NUMBER included)*/
+static const digit_kernel s_digit_kernels[] = {
+    DIGIT_KERNEL(6), DIGIT_KERNEL(8), DIGIT_KERNEL(12), DIGIT_KERNEL(16),
+    DIGIT_KERNEL(24), DIGIT_KERNEL(32), DIGIT_KERNEL(48), DIGIT_KERNEL(64),
+};
+
+/**************************************************************************************
+ *                              DIGIT KERNEL FIND
+ **************************************************************************************/
+const digit_kernel* digit_kernel_find(int digitCount)
+{
+    for (size_t k = 0; k < sizeof(s_digit_kernels) / sizeof(s_digit_kernels[0]); k++)
+    {
+        if (s_digit_kernels[k].digitCount == digitCount)
+        {
+            return &s_digit_kernels[k];
+        }
+    }
+
+    return NULL;
+}
+
+/**************************************************************************************
+ *                              PARSE DIGIT COUNT
+ **************************************************************************************/
+int parse_digit_count(const char* text)
+{
+    long digitCount = strtol(text, NULL, 10);
+
+    if (digitCount <= 0 || digitCount > LENGTH_NUMBER_MAX || digit_kernel_find((int)digitCount) == NULL)
+    {
+        return 0;
+    }
+
+    return (int)digitCount;
+}
+
+
+/**************************************************************************************
+ *                             PARSE PERSIST OPTION
+ **************************************************************************************/
+int parse_persist_option(int argc, char* argv[], int* index, int* isValid)
+{
+    int i = *index;
+
+    if (i + 1 >= argc)
+    {
+        return 0;
+    }
+
+    const char* value = argv[i + 1];
+    char* end = NULL;
+
+    if (strcmp(argv[i], "--sync") == 0)
+    {
+        int mode = 0;
+        while (mode < PERSIST_SYNC_MODE_COUNT && strcmp(value, s_persist_sync_mode_names[mode]) != 0)
+        {
+            mode++;
+        }
+        if (mode == PERSIST_SYNC_MODE_COUNT)
+        {
+            *isValid = 0;
+        }
+        else
+        {
+            s_persist_options.mode = (persist_sync_mode)mode;
+        }
+    }
+    else if (strcmp(argv[i], "--sync-interval") == 0)
+    {
+        long intervalMs = strtol(value, &end, 10);
+        if (end == value || *end != '\0' || intervalMs < 0 || intervalMs > PERSIST_SYNC_MAX_INTERVAL_MS)
+        {
+            *isValid = 0;
+        }
+        s_persist_options.intervalMs = intervalMs;
+    }
+    else if (strcmp(argv[i], "--io") == 0)
+    {
+        int io = 0;
+        while (io < PERSIST_IO_BACKEND_COUNT && strcmp(value, s_persist_io_names[io]) != 0)
+        {
+            io++;
+        }
+        if (io == PERSIST_IO_BACKEND_COUNT)
+        {
+            *isValid = 0;
+        }
+        else
+        {
+            s_persist_options.io = (persist_io_backend)io;
+        }
+    }
+    else if (strcmp(argv[i], "--sync-batch") == 0)
+    {
+        long batchSize = strtol(value, &end, 10);
+        if (end == value || *end != '\0' || batchSize < 1 || batchSize > PERSIST_QUEUE_CAPACITY)
+        {
+            *isValid = 0;
+        }
+        s_persist_options.batchSize = batchSize;
+    }
+    else
+    {
+        return 0;
+    }
+
+    *index = i + 1;
+    return 1;
+}
+
+/**************************************************************************************
+ *                           COMPARE BATCH SCALAR
+ **************************************************************************************/
+void compare_batch_scalar(const char* magicNumbers, const char* inputNumbers, size_t count, uint8_t* matchMasks, uint8_t* isAllCorrect)
+{
+    for (size_t pair = 0; pair < count; pair++)
+    {
+        const char* magic = magicNumbers + pair * LENGTH_NUMBER;
+        const char* input = inputNumbers + pair * LENGTH_NUMBER;
+        uint8_t mask = 0;
+
+        for (int i = 0; i < LENGTH_NUMBER; i++)
+        {
+            mask |= (uint8_t)((magic[i] == input[i]) << i);
+        }
+
+        matchMasks[pair] = mask;
+        if (isAllCorrect != NULL)
+        {
+            isAllCorrect[pair] = (mask == COMPARE_ALL_MASK);
+        }
+    }
+}
+
+#if COMPARE_HAS_SIMD
+/**************************************************************************************
+ *                            COMPARE BATCH SSE2
+ **************************************************************************************/
+__attribute__((target("sse2")))
+void compare_batch_sse2(const char* magicNumbers, const char* inputNumbers, size_t count, uint8_t* matchMasks, uint8_t* isAllCorrect)
+{
+    size_t pair = 0;
+
+    /*8 pairs are LENGTH_NUMBER / 2 vectors of 16 bytes, one bit per byte in the movemask*/
+    for (; pair + 8 <= count; pair += 8)
+    {
+        const char* magic = magicNumbers + pair * LENGTH_NUMBER;
+        const char* input = inputNumbers + pair * LENGTH_NUMBER;
+        uint64_t bits = 0;
+
+        for (int v = 0; v < LENGTH_NUMBER / 2; v++)
+        {
+            __m128i magicVector = _mm_loadu_si128((const __m128i*)(magic + 16 * v));
+            __m128i inputVector = _mm_loadu_si128((const __m128i*)(input + 16 * v));
+            bits |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(magicVector, inputVector)) << (16 * v);
+        }
+
+        for (int k = 0; k < 8; k++)
+        {
+            uint8_t mask = (uint8_t)((bits >> (k * LENGTH_NUMBER)) & COMPARE_ALL_MASK);
+
+            matchMasks[pair + k] = mask;
+            if (isAllCorrect != NULL)
+            {
+                isAllCorrect[pair + k] = (mask == COMPARE_ALL_MASK);
+            }
+        }
+    }
+
+    compare_batch_scalar(magicNumbers + pair * LENGTH_NUMBER, inputNumbers + pair * LENGTH_NUMBER, count - pair,
+                         matchMasks + pair, (isAllCorrect != NULL) ? isAllCorrect + pair : NULL);
+}
+
+/**************************************************************************************
+ *                            COMPARE BATCH AVX2
+ **************************************************************************************/
+__attribute__((target("avx2")))
+void compare_batch_avx2(const char* magicNumbers, const char* inputNumbers, size_t count, uint8_t* matchMasks, uint8_t* isAllCorrect)
+{
+    size_t pair = 0;
+
+    /*16 pairs are LENGTH_NUMBER / 2 vectors of 32 bytes*/
+    for (; pair + 16 <= count; pair += 16)
+    {
+        const char* magic = magicNumbers + pair * LENGTH_NUMBER;
+        const char* input = inputNumbers + pair * LENGTH_NUMBER;
+        uint64_t words[2] = { 0, 0 };
+
+        for (int v = 0; v < LENGTH_NUMBER / 2; v++)
+        {
+            __m256i magicVector = _mm256_loadu_si256((const __m256i*)(magic + 32 * v));
+            __m256i inputVector = _mm256_loadu_si256((const __m256i*)(input + 32 * v));
+            words[v / 2] |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(magicVector, inputVector)) << (32 * (v % 2));
+        }
+
+        /*Split the 16 * LENGTH_NUMBER bits into 2 halves of 8 pairs*/
+#if LENGTH_NUMBER == 8
+        uint64_t halves[2] = { words[0], words[1] };
+#else
+        uint64_t halves[2] = { words[0], (words[0] >> (8 * LENGTH_NUMBER)) | (words[1] << (64 - 8 * LENGTH_NUMBER)) };
+#endif
+
+        for (int k = 0; k < 16; k++)
+        {
+            uint8_t mask = (uint8_t)((halves[k / 8] >> ((k % 8) * LENGTH_NUMBER)) & COMPARE_ALL_MASK);
+
+            matchMasks[pair + k] = mask;
+            if (isAllCorrect != NULL)
+            {
+                isAllCorrect[pair + k] = (mask == COMPARE_ALL_MASK);
+            }
+        }
+    }
+
+    compare_batch_scalar(magicNumbers + pair * LENGTH_NUMBER, inputNumbers + pair * LENGTH_NUMBER, count - pair,
+                         matchMasks + pair, (isAllCorrect != NULL) ? isAllCorrect + pair : NULL);
+}
+#endif
+
+/**
+ * @brief Batch compare kernels, the fastest first.
+ */
+static const compare_kernel s_compare_kernels[] = {
+#if COMPARE_HAS_SIMD
+    { "avx2", compare_batch_avx2 },
+    { "sse2", compare_batch_sse2 },
+#endif
+    { "scalar", compare_batch_scalar }
+};
+
+/**
+ * @brief Kernel run by `compare_batch`, selected once for the CPU.
+ */
+static const compare_kernel* s_compare_batch = &s_compare_kernels[sizeof(s_compare_kernels) / sizeof(s_compare_kernels[0]) - 1];
+static pthread_once_t s_compare_batch_once = PTHREAD_ONCE_INIT;
+
+/**************************************************************************************
+ *                           COMPARE BATCH SELECT
+ **************************************************************************************/
+static void compare_batch_select(void)
+{
+    /*Best kernel supported by the CPU*/
+    for (size_t i = 0; i < sizeof(s_compare_kernels) / sizeof(s_compare_kernels[0]); i++)
+    {
+        if (compare_kernel_is_supported(&s_compare_kernels[i]))
+        {
+            s_compare_batch = &s_compare_kernels[i];
+            return;
+        }
+    }
+}
+
+/**************************************************************************************
+ *                         COMPARE KERNEL IS SUPPORTED
+ **************************************************************************************/
+int compare_kernel_is_supported(const compare_kernel* kernel)
+{
+#if COMPARE_HAS_SIMD
+    __builtin_cpu_init();
+    if (kernel->function == compare_batch_avx2)
+    {
+        return __builtin_cpu_supports("avx2");
+    }
+    if (kernel->function == compare_batch_sse2)
+    {
+        return __builtin_cpu_supports("sse2");
+    }
+#endif
+    return kernel->function == compare_batch_scalar;
+}
+
+/**************************************************************************************
+ *                           COMPARE BATCH KERNEL
+ **************************************************************************************/
+const compare_kernel* compare_batch_kernel(void)
+{
+    pthread_once(&s_compare_batch_once, compare_batch_select);
+    return s_compare_batch;
+}
+
+/**************************************************************************************
+ *                               COMPARE BATCH
+ **************************************************************************************/
+void compare_batch(const char* magicNumbers, const char* inputNumbers, size_t count, uint8_t* matchMasks, uint8_t* isAllCorrect)
+{
+    compare_batch_kernel()->function(magicNumbers, inputNumbers, count, matchMasks, isAllCorrect);
+}
+
+/**************************************************************************************
+ *                          UPDATE HIGHEST PLAYERS
+ **************************************************************************************/
+void update_player_table(User* user, player_table* top_players)
+{
+    float userRatio = (float)user->rightGuess / user->totalGuess;
+
+    /* Keep the best result of the player */
+    player_table_update(top_players, user->userName, userRatio, user->timeRecord);
+}
+
+/**************************************************************************************
+ *                              PLAYER TABLE INIT
+ **************************************************************************************/
+int player_table_init(player_table* table)
+{
+    memset(table, 0, sizeof(*table));
+    table->root = -1;
+    table->nameCapacity = PLAYER_TABLE_MIN_NAMES;
+    table->nameSlots = malloc(table->nameCapacity * sizeof(int32_t));
+
+    if (table->nameSlots == NULL)
+    {
+        perror("Error allocating player table");
+        return 0;
+    }
+
+    memset(table->nameSlots, 0xFF, table->nameCapacity * sizeof(int32_t));
+    return 1;
+}
+
+/**************************************************************************************
+ *                              PLAYER TABLE FREE
+ **************************************************************************************/
+void player_table_free(player_table* table)
+{
+    if (table->mapping != NULL)
+    {
+        munmap(table->mapping, table->mappingSize);
+    }
+    else
+    {
+        free(table->nodes);
+        free(table->nameSlots);
+    }
+    memset(table, 0, sizeof(*table));
+    table->root = -1;
+}
+
+/**************************************************************************************
+ *                              PLAYER TABLE CLEAR
+ **************************************************************************************/
+void player_table_clear(player_table* table)
+{
+    table->nodeCount = 0;
+    table->root = -1;
+    table->nextSequence = 0;
+    memset(table->nameSlots, 0xFF, table->nameCapacity * sizeof(int32_t));
+}
+
+/**************************************************************************************
+ *                             PLAYER NODE COMPARE
+ **************************************************************************************/
+static int player_node_compare(const player_node* a, const player_node* b)
+{
+    /*Higher lucky ratio first, then lower time, then the older result*/
+    if (a->luckyRatio != b->luckyRatio)
+    {
+        return (a->luckyRatio > b->luckyRatio) ? -1 : 1;
+    }
+    if (a->timeRecord != b->timeRecord)
+    {
+        return (a->timeRecord < b->timeRecord) ? -1 : 1;
+    }
+    if (a->sequence != b->sequence)
+    {
+        return (a->sequence < b->sequence) ? -1 : 1;
+    }
+    return 0;
+}
+
+/**************************************************************************************
+ *                              PLAYER TREE HEIGHT
+ **************************************************************************************/
+static int32_t player_tree_height(const player_table* table, int32_t node)
+{
+    return (node < 0) ? 0 : table->nodes[node].height;
+}
+
+/**************************************************************************************
+ *                               PLAYER TREE SIZE
+ **************************************************************************************/
+static int32_t player_tree_size(const player_table* table, int32_t node)
+{
+    return (node < 0) ? 0 : table->nodes[node].size;
+}
+
+/**************************************************************************************
+ *                              PLAYER TREE UPDATE
+ **************************************************************************************/
+static void player_tree_update(player_table* table, int32_t node)
+{
+    int32_t leftHeight = player_tree_height(table, table->nodes[node].left);
+    int32_t rightHeight = player_tree_height(table, table->nodes[node].right);
+
+    table->nodes[node].height = 1 + ((leftHeight > rightHeight) ? leftHeight : rightHeight);
+    table->nodes[node].size = 1 + player_tree_size(table, table->nodes[node].left) + player_tree_size(table, table->nodes[node].right);
+}
+
+/**************************************************************************************
+ *                              PLAYER TREE ROTATE
+ **************************************************************************************/
+static int32_t player_tree_rotate_right(player_table* table, int32_t node)
+{
+    int32_t left = table->nodes[node].left;
+
+    table->nodes[node].left = table->nodes[left].right;
+    table->nodes[left].right = node;
+    player_tree_update(table, node);
+    player_tree_update(table, left);
+    return left;
+}
+
+static int32_t player_tree_rotate_left(player_table* table, int32_t node)
+{
+    int32_t right = table->nodes[node].right;
+
+    table->nodes[node].right = table->nodes[right].left;
+    table->nodes[right].left = node;
+    player_tree_update(table, node);
+    player_tree_update(table, right);
+    return right;
+}
+
+/**************************************************************************************
+ *                              PLAYER TREE BALANCE
+ **************************************************************************************/
+static int32_t player_tree_balance(player_table* table, int32_t node)
+{
+    player_node* n = &table->nodes[node];
+    int32_t balance = player_tree_height(table, n->left) - player_tree_height(table, n->right);
+
+    player_tree_update(table, node);
+
+    if (balance > 1)
+    {
+        const player_node* left = &table->nodes[n->left];
+        if (player_tree_height(table, left->left) < player_tree_height(table, left->right))
+        {
+            n->left = player_tree_rotate_left(table, n->left);
+        }
+        return player_tree_rotate_right(table, node);
+    }
+    if (balance < -1)
+    {
+        const player_node* right = &table->nodes[n->right];
+        if (player_tree_height(table, right->right) < player_tree_height(table, right->left))
+        {
+            n->right = player_tree_rotate_right(table, n->right);
+        }
+        return player_tree_rotate_left(table, node);
+    }
+
+    return node;
+}
+
+/**************************************************************************************
+ *                              PLAYER TREE INSERT
+ **************************************************************************************/
+static int32_t player_tree_insert(player_table* table, int32_t root, int32_t node)
+{
+    if (root < 0)
+    {
+        table->nodes[node].left = -1;
+        table->nodes[node].right = -1;
+        table->nodes[node].height = 1;
+        table->nodes[node].size = 1;
+        return node;
+    }
+
+    if (player_node_compare(&table->nodes[node], &table->nodes[root]) < 0)
+    {
+        table->nodes[root].left = player_tree_insert(table, table->nodes[root].left, node);
+    }
+    else
+    {
+        table->nodes[root].right = player_tree_insert(table, table->nodes[root].right, node);
+    }
+
+    return player_tree_balance(table, root);
+}
+
+/**************************************************************************************
+ *                            PLAYER TREE REMOVE MIN
+ **************************************************************************************/
+static int32_t player_tree_remove_min(player_table* table, int32_t root, int32_t* minNode)
+{
+    if (table->nodes[root].left < 0)
+    {
+        *minNode = root;
+        return table->nodes[root].right;
+    }
+
+    table->nodes[root].left = player_tree_remove_min(table, table->nodes[root].left, minNode);
+    return player_tree_balance(table, root);
+}
+
+/**************************************************************************************
+ *                              PLAYER TREE REMOVE
+ **************************************************************************************/
+static int32_t player_tree_remove(player_table* table, int32_t root, int32_t node)
+{
+    if (root < 0)
+    {
+        return -1;
+    }
+
+    int compare = player_node_compare(&table->nodes[node], &table->nodes[root]);
+
+    if (compare < 0)
+    {
+        table->nodes[root].left = player_tree_remove(table, table->nodes[root].left, node);
+    }
+    else if (compare > 0)
+    {
+        table->nodes[root].right = player_tree_remove(table, table->nodes[root].right, node);
+    }
+    else
+    {
+        /*Replace the node by the first node of its right subtree*/
+        int32_t left = table->nodes[root].left;
+        int32_t right = table->nodes[root].right;
+        int32_t minNode;
+
+        if (right < 0)
+        {
+            return left;
+        }
+
+        right = player_tree_remove_min(table, right, &minNode);
+        table->nodes[minNode].left = left;
+        table->nodes[minNode].right = right;
+        return player_tree_balance(table, minNode);
+    }
+
+    return player_tree_balance(table, root);
+}
+
+/**************************************************************************************
+ *                              PLAYER TABLE FIND
+ **************************************************************************************/
+static int32_t* player_table_find_slot(const player_table* table, const char* playerName)
+{
+    uint32_t mask = table->nameCapacity - 1;
+
+    /*Linear probing, players are never removed*/
+    for (uint32_t i = (uint32_t)user_name_hash(playerName) & mask; ; i = (i + 1) & mask)
+    {
+        int32_t* slot = &table->nameSlots[i];
+
+        if (*slot < 0 || strcmp(table->nodes[*slot].playerName, playerName) == 0)
+        {
+            return slot;
+        }
+    }
+}
+
+/**************************************************************************************
+ *                            PLAYER TABLE DETACH
+ **************************************************************************************/
+static int player_table_detach(player_table* table)
+{
+    /*Copy a table used in place from its file into the heap before it grows*/
+    int32_t nodeCapacity = (table->nodeCount > 0) ? table->nodeCount : PLAYER_TABLE_MIN_NAMES / 2;
+    player_node* nodes = malloc((size_t)nodeCapacity * sizeof(player_node));
+    int32_t* nameSlots = malloc(table->nameCapacity * sizeof(int32_t));
+
+    if (nodes == NULL || nameSlots == NULL)
+    {
+        perror("Error allocating player table");
+        free(nodes);
+        free(nameSlots);
+        return 0;
+    }
+
+    memcpy(nodes, table->nodes, (size_t)table->nodeCount * sizeof(player_node));
+    memcpy(nameSlots, table->nameSlots, table->nameCapacity * sizeof(int32_t));
+    munmap(table->mapping, table->mappingSize);
+
+    table->nodes = nodes;
+    table->nodeCapacity = nodeCapacity;
+    table->nameSlots = nameSlots;
+    table->mapping = NULL;
+    table->mappingSize = 0;
+    return 1;
+}
+
+/**************************************************************************************
+ *                              PLAYER TABLE GROW
+ **************************************************************************************/
+static int player_table_grow(player_table* table)
+{
+    if (table->mapping != NULL && !player_table_detach(table))
+    {
+        return 0;
+    }
+
+    /*Room for one more node*/
+    if (table->nodeCount == table->nodeCapacity)
+    {
+        int32_t capacity = (table->nodeCapacity > 0) ? table->nodeCapacity * 2 : PLAYER_TABLE_MIN_NAMES / 2;
+        player_node* nodes = realloc(table->nodes, (size_t)capacity * sizeof(player_node));
+
+        if (nodes == NULL)
+        {
+            perror("Error allocating player table");
+            return 0;
+        }
+        table->nodes = nodes;
+        table->nodeCapacity = capacity;
+    }
+
+    /*Keep the name map at most half full*/
+    if ((uint32_t)(table->nodeCount + 1) * 2 > table->nameCapacity)
+    {
+        uint32_t capacity = table->nameCapacity * 2;
+        int32_t* slots = malloc(capacity * sizeof(int32_t));
+
+        if (slots == NULL)
+        {
+            perror("Error allocating player table");
+            return 0;
+        }
+
+        free(table->nameSlots);
+        table->nameSlots = slots;
+        table->nameCapacity = capacity;
+        memset(table->nameSlots, 0xFF, capacity * sizeof(int32_t));
+
+        for (int32_t i = 0; i < table->nodeCount; i++)
+        {
+            *player_table_find_slot(table, table->nodes[i].playerName) = i;
+        }
+    }
+
+    return 1;
+}
+
+/**************************************************************************************
+ *                             PLAYER TABLE UPDATE
+ **************************************************************************************/
+int player_table_update(player_table* table, const char* playerName, float luckyRatio, float timeRecord)
+{
+    player_node result;
+
+    result.luckyRatio = luckyRatio;
+    result.timeRecord = timeRecord;
+    result.sequence = table->nextSequence;
+
+    int32_t* slot = player_table_find_slot(table, playerName);
+    int32_t node = *slot;
+
+    if (node >= 0)
+    {
+        /*Keep the best result of the player*/
+        if (player_node_compare(&result, &table->nodes[node]) >= 0)
+        {
+            return 0;
+        }
+        table->root = player_tree_remove(table, table->root, node);
+    }
+    else
+    {
+        if (!player_table_grow(table))
+        {
+            return -1;
+        }
+
+        node = table->nodeCount++;
+        *player_table_find_slot(table, playerName) = node;
+        memset(&table->nodes[node], 0, sizeof(table->nodes[node]));
+        strncpy(table->nodes[node].playerName, playerName, LENGTH_STRING_MAX);
+    }
+
+    table->nodes[node].luckyRatio = luckyRatio;
+    table->nodes[node].timeRecord = timeRecord;
+    table->nodes[node].sequence = table->nextSequence++;
+    table->root = player_tree_insert(table, table->root, node);
+    return 1;
+}
+
+/**************************************************************************************
+ *                               PLAYER TABLE TOP
+ **************************************************************************************/
+size_t player_table_top(const player_table* table, size_t count, const player_node** players)
+{
+    return player_table_range(table, 0, count, players);
+}
+
+/**************************************************************************************
+ *                              PLAYER TABLE RANGE
+ **************************************************************************************/
+size_t player_table_range(const player_table* table, size_t first, size_t count, const player_node** players)
+{
+    int32_t stack[PLAYER_TREE_MAX_HEIGHT];
+    int depth = 0;
+    int32_t node = table->root;
+    size_t found = 0;
+
+    /*Descend to the first node wanted, stacking the nodes still to visit after it*/
+    while (node >= 0)
+    {
+        size_t leftSize = (size_t)player_tree_size(table, table->nodes[node].left);
+
+        if (first <= leftSize)
+        {
+            stack[depth++] = node;
+            node = (first == leftSize) ? -1 : table->nodes[node].left;
+        }
+        else
+        {
+            first -= leftSize + 1;
+            node = table->nodes[node].right;
+        }
+    }
+
+    /*In-order walk, stopping after `count` players*/
+    while (found < count && (node >= 0 || depth > 0))
+    {
+        while (node >= 0)
+        {
+            stack[depth++] = node;
+            node = table->nodes[node].left;
+        }
+
+        node = stack[--depth];
+        players[found++] = &table->nodes[node];
+        node = table->nodes[node].right;
+    }
+
+    return found;
+}
+
+/**************************************************************************************
+ *                               PLAYER TABLE RANK
+ **************************************************************************************/
+int32_t player_table_rank(const player_table* table, const char* playerName)
+{
+    int32_t target = *player_table_find_slot(table, playerName);
+    int32_t node = table->root;
+    int32_t rank = 0;
+
+    if (target < 0)
+    {
+        return 0;
+    }
+
+    /*Count the better players on the path to the node of the player*/
+    while (node >= 0)
+    {
+        int compare = player_node_compare(&table->nodes[target], &table->nodes[node]);
+
+        if (compare < 0)
+        {
+            node = table->nodes[node].left;
+        }
+        else
+        {
+            rank += player_tree_size(table, table->nodes[node].left) + 1;
+            if (compare == 0)
+            {
+                return rank;
+            }
+            node = table->nodes[node].right;
+        }
+    }
+
+    return 0;
+}
+
+/**************************************************************************************
+ *                            PLAYER TABLE PERCENTILE
+ **************************************************************************************/
+float player_table_percentile(const player_table* table, int32_t rank)
+{
+    if (table->nodeCount <= 0 || rank <= 0)
+    {
+        return 0.0f;
+    }
+
+    return 100.0f * (float)(table->nodeCount - rank) / (float)table->nodeCount;
+}
+
+
+/**************************************************************************************
+ *                           PLAYER TABLE CHECKSUM
+ **************************************************************************************/
+uint64_t player_table_checksum(const player_file_header* header, const player_node* nodes, const int32_t* nameSlots)
+{
+    /*FNV-1a over the header fields, the nodes and the name map, 8 bytes at a time*/
+    uint64_t hash = 14695981039346656037ull;
+    uint64_t word;
+    const unsigned char* parts[2] = { (const unsigned char*)nodes, (const unsigned char*)nameSlots };
+    size_t sizes[2] = { (size_t)header->nodeCount * sizeof(player_node), header->nameCapacity * sizeof(int32_t) };
+
+    uint64_t fields[3] = { ((uint64_t)(uint32_t)header->nodeCount << 32) | (uint32_t)header->root,
+                           header->nameCapacity, header->nextSequence };
+    for (int i = 0; i < 3; i++)
+    {
+        hash = (hash ^ fields[i]) * 1099511628211ull;
+    }
+
+    for (int part = 0; part < 2; part++)
+    {
+        for (size_t offset = 0; offset < sizes[part]; offset += sizeof(word))
+        {
+            memcpy(&word, parts[part] + offset, sizeof(word));
+            hash = (hash ^ word) * 1099511628211ull;
+        }
+    }
+
+    return hash;
+}
+
+/**************************************************************************************
+ *                              PLAYER TABLE COPY
+ **************************************************************************************/
+int player_table_copy(player_table* copy, const player_table* table)
+{
+    if (copy->nodeCapacity < table->nodeCount)
+    {
+        player_node* nodes = realloc(copy->nodes, (size_t)table->nodeCount * sizeof(player_node));
+        if (nodes == NULL)
+        {
+            perror("Error allocating player table");
+            return 0;
+        }
+        copy->nodes = nodes;
+        copy->nodeCapacity = table->nodeCount;
+    }
+
+    if (copy->nameCapacity != table->nameCapacity)
+    {
+        int32_t* nameSlots = realloc(copy->nameSlots, table->nameCapacity * sizeof(int32_t));
+        if (nameSlots == NULL)
+        {
+            perror("Error allocating player table");
+            return 0;
+        }
+        copy->nameSlots = nameSlots;
+        copy->nameCapacity = table->nameCapacity;
+    }
+
+    memcpy(copy->nodes, table->nodes, (size_t)table->nodeCount * sizeof(player_node));
+    memcpy(copy->nameSlots, table->nameSlots, table->nameCapacity * sizeof(int32_t));
+    copy->nodeCount = table->nodeCount;
+    copy->root = table->root;
+    copy->nextSequence = table->nextSequence;
+    return 1;
+}
+
+/**************************************************************************************
+ *                               SAVE TOP PLAYERS
+ **************************************************************************************/
+void save_player_table_to_file(const player_table* top_players)
+{
+    player_table_save(top_players, NULL);
+}
+
+/**************************************************************************************
+ *                               PLAYER TABLE SAVE
+ **************************************************************************************/
+int player_table_save(const player_table* top_players, io_ring* ring)
+{
+    player_file_header header;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PLAYER_FILE_MAGIC, sizeof(header.magic));
+    header.version = PLAYER_FILE_VERSION;
+    header.nodeSize = sizeof(player_node);
+    header.nodeCount = top_players->nodeCount;
+    header.root = top_players->root;
+    header.nameCapacity = top_players->nameCapacity;
+    header.nextSequence = top_players->nextSequence;
+    header.checksum = player_table_checksum(&header, top_players->nodes, top_players->nameSlots);
+
+    /*The memory image of the table: header, nodes and name map*/
+    struct iovec parts[3] = {
+        { &header, sizeof(header) },
+        { top_players->nodes, (size_t)top_players->nodeCount * sizeof(player_node) },
+        { top_players->nameSlots, top_players->nameCapacity * sizeof(int32_t) }
+    };
+    ssize_t expectedSize = (ssize_t)(parts[0].iov_len + parts[1].iov_len + parts[2].iov_len);
+
+    pthread_mutex_lock(&s_file_mutex);
+    int fd = open(PLAYER_FILE ".tmp", O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    /*Check open file success*/
+    if (fd < 0) 
+    {
+        pthread_mutex_unlock(&s_file_mutex);
+        perror("Error opening file");
+        return 0;
+    }
+
+    /*The copy is synced here, before the rename, by the ring or by fsync*/
+    int isDurable = (s_persist_options.mode != PERSIST_SYNC_NONE);
+    int result = 0;
+    unsigned operationCount = (ring != NULL) ? (unsigned)player_table_ring_prepare(ring, fd, parts, 3, isDurable) : 0;
+    if (operationCount > 0)
+    {
+        uint64_t callCount = 0;
+        result = io_ring_submit(ring, operationCount, &callCount);
+    }
+    else
+    {
+        /*A short write sets no error of its own*/
+        ssize_t written = writev(fd, parts, 3);
+        if (written >= 0 && written != expectedSize)
+        {
+            errno = EIO;
+        }
+        result = (written == expectedSize) && (!isDurable || fsync(fd) == 0);
+    }
+
+    /*Replace the file only once it is complete*/
+    if (result == 0)
+    {
+        perror("Error writing file");
+        unlink(PLAYER_FILE ".tmp");
+    }
+    else if (!file_replace(-1, PLAYER_FILE ".tmp", PLAYER_FILE))
+    {
+        result = 0;
+    }
+    close(fd);
+
+    pthread_mutex_unlock(&s_file_mutex);
+    return result;
+}
+
+/**************************************************************************************
+ *                                FILE REPLACE
+ **************************************************************************************/
+int file_replace(int fd, const char* tmpPath, const char* path)
+{
+    int isDurable = (s_persist_options.mode != PERSIST_SYNC_NONE);
+
+    if ((isDurable && fd >= 0 && fsync(fd) < 0) || rename(tmpPath, path) < 0)
+    {
+        perror("Error writing file");
+        unlink(tmpPath);
+        return 0;
+    }
+
+    /*The rename itself is durable once the directory entry is synced*/
+    if (isDurable)
+    {
+        char directory[4096] = ".";
+        const char* slash = strrchr(path, '/');
+        if (slash != NULL)
+        {
+            snprintf(directory, sizeof(directory), "%.*s", (slash == path) ? 1 : (int)(slash - path), path);
+        }
+
+        int directoryFd = open(directory, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (directoryFd < 0 || fsync(directoryFd) < 0)
+        {
+            perror("Error syncing directory");
+        }
+        if (directoryFd >= 0)
+        {
+            close(directoryFd);
+        }
+    }
+
+    return 1;
+}
+
+/**************************************************************************************
+ *                               READ TOP PLAYERS
+ **************************************************************************************/
+int read_player_table_from_file(player_table* top_players) 
+{
+    pthread_mutex_lock(&s_file_mutex);
+    int fd = open(PLAYER_FILE, O_RDONLY | O_CLOEXEC);
+
+    /*Check open file action */
+    if (fd < 0) 
+    {
+        pthread_mutex_unlock(&s_file_mutex);
+        perror("Error opening file");
+        return 0;
+    }
+
+    struct stat fileStat;
+    void* mapping = MAP_FAILED;
+
+    /*Private writable mapping: the table is updated in place, the file never changes*/
+    if (fstat(fd, &fileStat) == 0 && (size_t)fileStat.st_size >= sizeof(player_file_header))
+    {
+        mapping = mmap(NULL, (size_t)fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    pthread_mutex_unlock(&s_file_mutex);
+
+    if (mapping == MAP_FAILED)
+    {
+        fprintf(stderr, "%s cannot be read\n", PLAYER_FILE);
+        return 0;
+    }
+
+    const player_file_header* header = (const player_file_header*)mapping;
+    player_node* nodes = (player_node*)((char*)mapping + sizeof(player_file_header));
+    int32_t* nameSlots = (int32_t*)(nodes + ((header->nodeCount > 0) ? header->nodeCount : 0));
+
+    /*Check the format, the size and the checksum, nothing is parsed*/
+    int isValid = memcmp(header->magic, PLAYER_FILE_MAGIC, sizeof(header->magic)) == 0 &&
+                  header->version == PLAYER_FILE_VERSION &&
+                  header->nodeSize == sizeof(player_node) &&
+                  header->nodeCount >= 0 &&
+                  header->root >= -1 && header->root < header->nodeCount &&
+                  header->nameCapacity >= PLAYER_TABLE_MIN_NAMES &&
+                  (header->nameCapacity & (header->nameCapacity - 1)) == 0 &&
+                  (uint64_t)header->nodeCount * 2 <= header->nameCapacity &&
+                  (uint64_t)fileStat.st_size == sizeof(player_file_header) + (uint64_t)header->nodeCount * sizeof(player_node) +
+                                                (uint64_t)header->nameCapacity * sizeof(int32_t) &&
+                  header->checksum == player_table_checksum(header, nodes, nameSlots);
+
+    if (!isValid)
+    {
+        fprintf(stderr, "%s has an unknown format or is corrupted\n", PLAYER_FILE);
+        munmap(mapping, (size_t)fileStat.st_size);
+        return 0;
+    }
+
+    /*Use the nodes and the name map in place*/
+    player_table_free(top_players);
+    top_players->nodes = nodes;
+    top_players->nodeCount = header->nodeCount;
+    top_players->nodeCapacity = header->nodeCount;
+    top_players->root = header->root;
+    top_players->nameSlots = nameSlots;
+    top_players->nameCapacity = header->nameCapacity;
+    top_players->nextSequence = header->nextSequence;
+    top_players->mapping = mapping;
+    top_players->mappingSize = (size_t)fileStat.st_size;
+    return 1;
+}
+
+/**************************************************************************************
+ *                            EXPORT TOP PLAYERS
+ **************************************************************************************/
+void export_player_table_to_text(const player_table* top_players)
+{
+    const player_node** players = malloc(((size_t)top_players->nodeCount + 1) * sizeof(*players));
+    if (players == NULL)
+    {
+        perror("Error allocating player table");
+        return;
+    }
+    size_t count = player_table_top(top_players, (size_t)top_players->nodeCount, players);
+
+    pthread_mutex_lock(&s_file_mutex);
+    FILE* file = fopen("top_players.txt.tmp", "w");
+
+    /*Check open file success*/
+    if (file == NULL) 
+    {
+        pthread_mutex_unlock(&s_file_mutex);
+        perror("Error opening file");
+        free(players);
+        return;
+    }
+
+    /*Save top players*/
+    fprintf(file, "TOP PLAYERS TABLE\n");
+    for (size_t i = 0; i < count; i++) 
+    {
+        fprintf(file, "%zu. %s - %.2f - %.2fs\n", i + 1, players[i]->playerName, players[i]->luckyRatio, players[i]->timeRecord);
+    }
+
+    /*Replace the export only once it is complete*/
+    if (fflush(file) != 0 || ferror(file))
+    {
+        perror("Error writing file");
+        unlink("top_players.txt.tmp");
+    }
+    else
+    {
+        file_replace(fileno(file), "top_players.txt.tmp", "top_players.txt");
+    }
+    fclose(file);
+    pthread_mutex_unlock(&s_file_mutex);
+    free(players);
+}
+
+/**************************************************************************************
+ *                            IMPORT TOP PLAYERS
+ **************************************************************************************/
+int import_player_table_from_text(player_table* top_players) 
+{
+    pthread_mutex_lock(&s_file_mutex);
+    FILE* file = fopen("top_players.txt", "r");
+
+    /*Check open file action */
+    if (file == NULL) 
+    {
+        pthread_mutex_unlock(&s_file_mutex);
+        perror("Error opening file");
+        return 0;
+    }
+
+    char line[1000];
+    int  skipFirstLine = 1;
+
+    // Initialize the player_table
+    player_table_clear(top_players);
+
+    while (fgets(line, sizeof(line), file) != NULL) 
+    {
+        /*Skip the first line*/
+        if (skipFirstLine) 
+        {
+            skipFirstLine = 0;
+            continue;
+        }
+
+        /*Manually parse the line for player name, lucky ratio, and time record*/
+        char name[LENGTH_STRING_MAX + 1] = {0};
+        float ratio = 0.0f;
+        double time = 0.0;
+
+        /* Use sscanf to parse the line */
+        if (sscanf(line, "%*d. %20s - %f - %lfs", name, &ratio, &time) == 3) 
+        {
+            /* Store the parsed values, in rank order (an older file may list a player twice)*/
+            player_table_update(top_players, name, ratio, (float)time);
+        }
+    }
+
+    fclose(file);
+    pthread_mutex_unlock(&s_file_mutex);
+    return 1;
+}
+
+/**************************************************************************************
+ *                            PRINT 10 TOP PLAYERS
+ **************************************************************************************/
+void print_high_score(const game_session* session, player_table *top_players)
+{
+    const player_node* players[PLAYER_TABLE_PRINT_COUNT];
+    size_t count = player_table_top(top_players, PLAYER_TABLE_PRINT_COUNT, players);
+
+    session_printf(session, "Top 10 Players read from file:\n");
+    for (size_t i = 0; i < count; i++) 
+    {
+        session_printf(session, "%zu. %s - %.2f - %.2fs\n", i + 1, players[i]->playerName, players[i]->luckyRatio, players[i]->timeRecord);
+    }
+}
+
+/**************************************************************************************
+ *                            PRINT PLAYER RANK
+ **************************************************************************************/
+void print_player_rank(const game_session* session, const player_table* top_players, const char* playerName)
+{
+    int32_t rank = player_table_rank(top_players, playerName);
+
+    if (rank > 0)
+    {
+        session_printf(session, "Your rank: %d of %d players (better than %.2f%% of the players)\n",
+                       rank, top_players->nodeCount, player_table_percentile(top_players, rank));
+    }
+}
+
+/**************************************************************************************
+ *                          PRINT PLAYER NEIGHBORS
+ **************************************************************************************/
+void print_player_neighbors(const game_session* session, const player_table* top_players, const char* playerName)
+{
+    const player_node* players[2 * PLAYER_TABLE_NEIGHBOR_COUNT + 1];
+    int32_t rank = player_table_rank(top_players, playerName);
+
+    if (rank <= 0)
+    {
+        return;
+    }
+
+    size_t first = (rank > PLAYER_TABLE_NEIGHBOR_COUNT) ? (size_t)(rank - 1 - PLAYER_TABLE_NEIGHBOR_COUNT) : 0;
+    size_t count = player_table_range(top_players, first, 2 * PLAYER_TABLE_NEIGHBOR_COUNT + 1, players);
+
+    session_printf(session, "Players around you:\n");
+    for (size_t i = 0; i < count; i++) 
+    {
+        session_printf(session, "%zu. %s - %.2f - %.2fs%s\n", first + i + 1, players[i]->playerName, players[i]->luckyRatio, players[i]->timeRecord,
+                       (first + i + 1 == (size_t)rank) ? " <- you" : "");
+    }
+}
+
+/**************************************************************************************
+ *                            SAVE A LIST OF USER TO LOGFILE
+ **************************************************************************************/
+void save_user_list_to_file(const game_history* history) {
+    pthread_mutex_lock(&s_file_mutex);
+    FILE *file = fopen("log.txt.tmp", "w");
+    if (file == NULL) {
+        pthread_mutex_unlock(&s_file_mutex);
+        perror("Error opening file");
+        return;
+    }
+
+    static const game_entry emptyEntry;
+
+    for (int i = 0; i < 10; ++i) {
+        const game_entry* entry = game_history_at(history, (size_t)i);
+        if (entry == NULL) {
+            entry = &emptyEntry; // Fewer than 10 games yet
+        }
+
+        fprintf(file, "Entry %d:\n", i + 1); // Print the sequence number
+        fprintf(file, "Username: %s\n", entry->user.userName);
+        fprintf(file, "Total Guesses: %d\n", entry->user.totalGuess);
+        fprintf(file, "Right Guesses: %d\n", entry->user.rightGuess);
+        fprintf(file, "Time Record: %.2f\n", entry->user.timeRecord);
+        char magicText[LENGTH_NUMBER_MAX + 1] = "";
+        char commonText[LENGTH_NUMBER_MAX + 1] = "";
+        if (strlen(entry->user.userName) > 0) {
+            packed_digits_format(&entry->magicNumber, DIGIT_MASK_ALL(entry->digitCount), entry->digitCount, magicText);
+            packed_digits_format(&entry->magicNumber, entry->commonMask, entry->digitCount, commonText);
+        }
+        fprintf(file, "Magic Number: %s\n", magicText); // Save magic number as a string
+        fprintf(file, "Common Char: %s\n", commonText);  // Save common char sequence
+        fprintf(file, "Magic numer guessed done: %d\n", entry->isAllCorrect); 
+        fprintf(file, "-------------------------\n");
+    }
+
+    /*Replace the export only once it is complete*/
+    if (fflush(file) != 0 || ferror(file)) {
+        perror("Error writing file");
+        unlink("log.txt.tmp");
+    } else {
+        file_replace(fileno(file), "log.txt.tmp", "log.txt");
+    }
+    fclose(file);
+    pthread_mutex_unlock(&s_file_mutex);
+}
+
+/**************************************************************************************
+ *                            SAVE NEW USER TO LOGFILE
+ **************************************************************************************/
+void save_user_to_file(game_history* history, const game_session* session, User user, int isAllCorrect) {
+     
+    /* Add the new user, removing the oldest one */ 
+    game_history_insert(history, session, user, isAllCorrect);
+
+    /* Write the game into its slot of the ring file */
+    log_record record;
+    log_record_from_game(&record, session, user, isAllCorrect);
+
+    /* The index file follows the ring file, when a persistent store has it open */
+    pthread_mutex_lock(&s_file_mutex);
+    if (log_ring_append(&record) && s_pending_file_users > 0) {
+        pending_index_apply(&s_pending_file_index, &record);
+        pending_index_sync(&s_pending_file_index);
+    }
+    pthread_mutex_unlock(&s_file_mutex);
+}
+
+/**************************************************************************************
+ *                               LOAD LIST
+ **************************************************************************************/
+long load_user_list_from_file(game_history* history, User user)
+{
+    /*Read the records, no parsing*/
+    pthread_mutex_lock(&s_file_mutex);
+    long count = log_ring_load(history);
+    pthread_mutex_unlock(&s_file_mutex);
+
+    if (count <= 0)
+    {
+        return -1; // No journal or no game recorded yet
+    }
+
+    /*Check incompleting game account*/
+    return game_history_find_unfinished(history, user);
+}
+
+/**************************************************************************************
+ *                            LOG RECORD FROM GAME
+ **************************************************************************************/
+void log_record_from_game(log_record* record, const game_session* session, User user, int isAllCorrect)
+{
+    memset(record, 0, sizeof(*record));
+    strcpy(record->userName, user.userName);
+    record->magicNumber = session->magicNumber;
+    record->commonMask = session->commonMask;
+    record->digitCount = (uint8_t)session->digitKernel->digitCount;
+    record->totalGuess = user.totalGuess;
+    record->rightGuess = user.rightGuess;
+    record->timeRecord = user.timeRecord;
+    record->isAllCorrect = isAllCorrect;
+}
+
+/**************************************************************************************
+ *                            LOG RECORD TO ENTRY
+ **************************************************************************************/
+void log_record_to_entry(const log_record* record, game_entry* entry)
+{
+    memset(entry, 0, sizeof(*entry));
+    memcpy(entry->user.userName, record->userName, LENGTH_STRING_MAX);
+    entry->magicNumber = record->magicNumber;
+    entry->commonMask = record->commonMask;
+    entry->digitCount = (digit_kernel_find(record->digitCount) != NULL) ? record->digitCount : LENGTH_NUMBER;
+    entry->user.totalGuess = record->totalGuess;
+    entry->user.rightGuess = record->rightGuess;
+    entry->user.timeRecord = record->timeRecord;
+    entry->isAllCorrect = record->isAllCorrect;
+}
+
+/**************************************************************************************
+ *                            LOG RING HEADER INIT
+ **************************************************************************************/
+static void log_ring_header_init(log_ring_header* header, uint64_t capacity)
+{
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, LOG_RING_MAGIC, sizeof(header->magic));
+    header->version = LOG_RING_VERSION;
+    header->recordSize = sizeof(log_record);
+    header->capacity = capacity;
+}
+
+/**************************************************************************************
+ *                               LOG RING CREATE
+ **************************************************************************************/
+static int log_ring_create(int fd, uint64_t capacity)
+{
+    log_ring_header header;
+    log_ring_header_init(&header, capacity);
+
+    /*Empty slots are zeros (sequence 0), the file is sparse until they are written*/
+    if (ftruncate(fd, 0) < 0 ||
+        pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        ftruncate(fd, (off_t)(sizeof(header) + capacity * sizeof(log_record))) < 0)
+    {
+        perror("Error writing file");
+        return 0;
+    }
+
+    return 1;
+}
+
+/**************************************************************************************
+ *                              LOG RING MAP SLOTS
+ **************************************************************************************/
+static log_record* log_ring_map_slots(int fd, uint64_t capacity, int isWritable, size_t* mappingSize)
+{
+    *mappingSize = sizeof(log_ring_header) + capacity * sizeof(log_record);
+
+    void* mapping = mmap(NULL, *mappingSize, isWritable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        perror("Error mapping file");
+        return NULL;
+    }
+
+    return (log_record*)((char*)mapping + sizeof(log_ring_header));
+}
+
+/**************************************************************************************
+ *                            LOG RING UNMAP SLOTS
+ **************************************************************************************/
+static void log_ring_unmap_slots(log_record* slots, size_t mappingSize)
+{
+    munmap((char*)slots - sizeof(log_ring_header), mappingSize);
+}
+
+/**************************************************************************************
+ *                            LOG RING LAST SEQUENCE
+ **************************************************************************************/
+static uint64_t log_ring_last_sequence(const log_record* slots, uint64_t capacity)
+{
+    /*Game n is in slot n % capacity: from slot 1 on, the sequences grow up to the newest game,
+      then drop to the older round (or to the empty slots), so a binary search finds it
+      without reading the whole file*/
+    uint64_t foundSequence = 0;
+    int isFound = 0;
+    if (capacity > 1 && slots[1].sequence != 0)
+    {
+        uint64_t low = 1;
+        uint64_t high = capacity - 1;
+        while (low < high)
+        {
+            uint64_t middle = low + (high - low + 1) / 2;
+            if (slots[middle].sequence >= slots[1].sequence)
+            {
+                low = middle;
+            }
+            else
+            {
+                high = middle - 1;
+            }
+        }
+
+        foundSequence = (slots[0].sequence > slots[low].sequence) ? slots[0].sequence : slots[low].sequence;
+        isFound = (slots[low].sequence % capacity == low && slots[0].sequence % capacity == 0);
+    }
+    else if (slots[0].sequence % capacity == 0 && (capacity == 1 || slots[capacity - 1].sequence == 0))
+    {
+        foundSequence = slots[0].sequence;
+        isFound = 1;
+    }
+
+    /*A lost batch (failed write, crash before its sync) leaves a hole of at most one batch the
+      search may stop at: the slots after the newest game hold the older round or nothing*/
+    uint64_t window = (capacity - 1 < PERSIST_QUEUE_CAPACITY + 1) ? capacity - 1 : PERSIST_QUEUE_CAPACITY + 1;
+    for (uint64_t i = 1; isFound && i <= window; i++)
+    {
+        isFound = (slots[(foundSequence + i) % capacity].sequence <= foundSequence);
+    }
+    if (isFound)
+    {
+        return foundSequence;
+    }
+
+    /*A file which does not follow the layout: read every slot*/
+    uint64_t lastSequence = 0;
+
+    for (uint64_t i = 0; i < capacity; i++)
+    {
+        if (slots[i].sequence > lastSequence)
+        {
+            lastSequence = slots[i].sequence;
+        }
+    }
+
+    return lastSequence;
+}
+
+/**************************************************************************************
+ *                               LOG RING RESIZE
+ **************************************************************************************/
+static int log_ring_resize(int fd, uint64_t oldCapacity, uint64_t capacity)
+{
+    size_t oldMappingSize;
+    size_t newMappingSize;
+
+    int newFd = open(LOG_RING_FILE ".tmp", O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (newFd < 0)
+    {
+        perror("Error opening file");
+        return -1;
+    }
+
+    log_record* oldSlots = log_ring_map_slots(fd, oldCapacity, 0, &oldMappingSize);
+    log_record* newSlots = NULL;
+
+    if (oldSlots == NULL || !log_ring_create(newFd, capacity) ||
+        (newSlots = log_ring_map_slots(newFd, capacity, 1, &newMappingSize)) == NULL)
+    {
+        if (oldSlots != NULL)
+        {
+            log_ring_unmap_slots(oldSlots, oldMappingSize);
+        }
+        close(newFd);
+        unlink(LOG_RING_FILE ".tmp");
+        return -1;
+    }
+
+    /*Move the newest games to their slot in the new capacity*/
+    uint64_t lastSequence = log_ring_last_sequence(oldSlots, oldCapacity);
+    uint64_t keptCount = (oldCapacity < capacity) ? oldCapacity : capacity;
+    uint64_t firstSequence = (lastSequence > keptCount) ? lastSequence - keptCount + 1 : 1;
+
+    for (uint64_t sequence = firstSequence; sequence <= lastSequence; sequence++)
+    {
+        const log_record* record = &oldSlots[sequence % oldCapacity];
+        if (record->sequence == sequence)
+        {
+            newSlots[sequence % capacity] = *record;
+        }
+    }
+
+    log_ring_unmap_slots(oldSlots, oldMappingSize);
+    log_ring_unmap_slots(newSlots, newMappingSize);
+
+    if (!file_replace(newFd, LOG_RING_FILE ".tmp", LOG_RING_FILE))
+    {
+        close(newFd);
+        return -1;
+    }
+
+    close(fd);
+    return newFd;
+}
+
+/**************************************************************************************
+ *                                LOG RING OPEN
+ **************************************************************************************/
+int log_ring_open(uint64_t capacity)
+{
+    if (s_log_ring_fd >= 0)
+    {
+        return 1;
+    }
+
+    int fd = open(LOG_RING_FILE, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        perror("Error opening file");
+        return 0;
+    }
+
+    log_ring_header header;
+    log_ring_header expectedHeader;
+    struct stat fileStat;
+
+    log_ring_header_init(&expectedHeader, capacity);
+    if (fstat(fd, &fileStat) < 0)
+    {
+        perror("Error opening file");
+        close(fd);
+        return 0;
+    }
+
+    int isValid = pread(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header) &&
+                  memcmp(header.magic, expectedHeader.magic, sizeof(header.magic)) == 0 &&
+                  header.version == expectedHeader.version &&
+                  header.recordSize == expectedHeader.recordSize &&
+                  header.capacity > 0 &&
+                  (uint64_t)fileStat.st_size >= sizeof(header) + header.capacity * sizeof(log_record);
+
+    if (!isValid)
+    {
+        /*Start a new ring when the file is empty or has another format*/
+        if (fileStat.st_size > 0)
+        {
+            fprintf(stderr, "%s has an unknown format, starting a new log\n", LOG_RING_FILE);
+        }
+
+        if (!log_ring_create(fd, capacity))
+        {
+            close(fd);
+            return 0;
+        }
+    }
+    else if (header.capacity != capacity)
+    {
+        /*Keep the newest games in a file of the new capacity*/
+        int newFd = log_ring_resize(fd, header.capacity, capacity);
+        if (newFd < 0)
+        {
+            close(fd);
+            return 0;
+        }
+        fd = newFd;
+    }
+
+    /*Continue after the newest game of the file*/
+    size_t mappingSize;
+    log_record* slots = log_ring_map_slots(fd, capacity, 0, &mappingSize);
+    if (slots == NULL)
+    {
+        close(fd);
+        return 0;
+    }
+
+    s_log_ring_next = log_ring_last_sequence(slots, capacity) + 1;
+    log_ring_unmap_slots(slots, mappingSize);
+
+    s_log_ring_fd = fd;
+    s_log_ring_capacity = capacity;
+    return 1;
+}
+
+/**************************************************************************************
+ *                               LOG RING APPEND
+ **************************************************************************************/
+int log_ring_append(log_record* record)
+{
+    return log_ring_write(record, 1);
+}
+
+/**************************************************************************************
+ *                                LOG RING WRITE
+ **************************************************************************************/
+int log_ring_write(log_record* records, size_t count)
+{
+    if (!log_ring_open(GAME_HISTORY_DEFAULT_CAPACITY))
+    {
+        return 0;
+    }
+
+    /*Consecutive games have consecutive slots: one write until the end of the ring*/
+    size_t written = 0;
+    int writeCount = 0;
+    while (written < count)
+    {
+        uint64_t slot = s_log_ring_next % s_log_ring_capacity;
+        size_t run = count - written;
+        if (run > s_log_ring_capacity - slot)
+        {
+            run = (size_t)(s_log_ring_capacity - slot);
+        }
+
+        for (size_t i = 0; i < run; i++)
+        {
+            records[written + i].sequence = s_log_ring_next + i;
+        }
+
+        off_t offset = (off_t)(sizeof(log_ring_header) + slot * sizeof(log_record));
+        ssize_t size = (ssize_t)(run * sizeof(log_record));
+        ssize_t writtenSize = pwrite(s_log_ring_fd, &records[written], (size_t)size, offset);
+        if (writtenSize != size)
+        {
+            /*A short write sets no error of its own*/
+            if (writtenSize >= 0)
+            {
+                errno = EIO;
+            }
+            perror("Error writing file");
+            return 0;
+        }
+
+        s_log_ring_next += run;
+        written += run;
+        writeCount++;
+    }
+
+    return writeCount;
+}
+
+/**************************************************************************************
+ *                              IO RING NEXT SQE
+ **************************************************************************************/
+#ifdef HAVE_IO_URING
+static struct io_uring_sqe* io_ring_next_sqe(io_ring* ring, unsigned position)
+{
+    unsigned index = (*ring->sqTail + position) & ring->sqMask;
+    struct io_uring_sqe* sqe = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sqArray[index] = index;
+    return sqe;
+}
+#endif
+
+/**************************************************************************************
+ *                               LOG RING PREPARE
+ **************************************************************************************/
+int log_ring_prepare(io_ring* ring, log_record* records, size_t count, int isSynced)
+{
+#ifdef HAVE_IO_URING
+    if (!log_ring_open(GAME_HISTORY_DEFAULT_CAPACITY) || count > s_log_ring_capacity)
+    {
+        return 0;
+    }
+
+    /*At most two writes: until the end of the ring, then from its beginning*/
+    uint64_t slot = s_log_ring_next % s_log_ring_capacity;
+    size_t firstRun = (count < s_log_ring_capacity - slot) ? count : (size_t)(s_log_ring_capacity - slot);
+    size_t runs[2] = { firstRun, count - firstRun };
+    uint64_t slots[2] = { slot, 0 };
+    unsigned operationCount = 0;
+    size_t written = 0;
+
+    for (int i = 0; i < 2 && runs[i] > 0; i++)
+    {
+        struct io_uring_sqe* sqe = io_ring_next_sqe(ring, operationCount++);
+
+        ring->iovecs[i].iov_base = &records[written];
+        ring->iovecs[i].iov_len = runs[i] * sizeof(log_record);
+        sqe->opcode = IORING_OP_WRITEV;
+        sqe->fd = s_log_ring_fd;
+        sqe->off = sizeof(log_ring_header) + slots[i] * sizeof(log_record);
+        sqe->addr = (uint64_t)(uintptr_t)&ring->iovecs[i];
+        sqe->len = 1;
+        sqe->user_data = ring->iovecs[i].iov_len;
+        sqe->flags = isSynced ? IOSQE_IO_LINK : 0;
+        written += runs[i];
+    }
+
+    /*The sync is linked after the writes, it starts once they are done*/
+    if (isSynced)
+    {
+        struct io_uring_sqe* sqe = io_ring_next_sqe(ring, operationCount++);
+
+        sqe->opcode = IORING_OP_FSYNC;
+        sqe->fd = s_log_ring_fd;
+        sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+        sqe->user_data = 0;
+    }
+
+    /*The slots are taken now, the writes can run without the file mutex*/
+    for (size_t i = 0; i < count; i++)
+    {
+        records[i].sequence = s_log_ring_next + i;
+    }
+    s_log_ring_next += count;
+    return (int)operationCount;
+#else
+    (void)ring;
+    (void)records;
+    (void)count;
+    (void)isSynced;
+    return 0;
+#endif
+}
+
+/**************************************************************************************
+ *                               LOG RING RELEASE
+ **************************************************************************************/
+void log_ring_release(const log_record* records, size_t count)
+{
+    if (count > 0 && s_log_ring_next == records[count - 1].sequence + 1)
+    {
+        s_log_ring_next = records[0].sequence;
+    }
+}
+
+/**************************************************************************************
+ *                           PLAYER TABLE RING PREPARE
+ **************************************************************************************/
+int player_table_ring_prepare(io_ring* ring, int fd, const struct iovec* parts, int count, int isSynced)
+{
+#ifdef HAVE_IO_URING
+    if (count <= 0 || count > IO_RING_ENTRIES)
+    {
+        return 0;
+    }
+
+    /*One write of all the parts, from the beginning of the file*/
+    struct io_uring_sqe* sqe = io_ring_next_sqe(ring, 0);
+    uint64_t expectedSize = 0;
+    for (int i = 0; i < count; i++)
+    {
+        ring->iovecs[i] = parts[i];
+        expectedSize += parts[i].iov_len;
+    }
+    sqe->opcode = IORING_OP_WRITEV;
+    sqe->fd = fd;
+    sqe->off = 0;
+    sqe->addr = (uint64_t)(uintptr_t)ring->iovecs;
+    sqe->len = (unsigned)count;
+    sqe->user_data = expectedSize;
+    sqe->flags = isSynced ? IOSQE_IO_LINK : 0;
+    if (!isSynced)
+    {
+        return 1;
+    }
+
+    /*A new file: its size is synced too, so a full fsync*/
+    sqe = io_ring_next_sqe(ring, 1);
+    sqe->opcode = IORING_OP_FSYNC;
+    sqe->fd = fd;
+    sqe->user_data = 0;
+    return 2;
+#else
+    (void)ring;
+    (void)fd;
+    (void)parts;
+    (void)count;
+    (void)isSynced;
+    return 0;
+#endif
+}
+
+/**************************************************************************************
+ *                                IO RING INIT
+ **************************************************************************************/
+int io_ring_init(io_ring* ring, unsigned entries)
+{
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+
+#ifdef HAVE_IO_URING
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0)
+    {
+        return 0;
+    }
+
+    /*Map the submission ring, the completion ring (the same mapping on recent kernels) and the entries*/
+    ring->sqMappingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqMappingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (ring->cqMappingSize > ring->sqMappingSize)
+        {
+            ring->sqMappingSize = ring->cqMappingSize;
+        }
+        ring->cqMappingSize = ring->sqMappingSize;
+    }
+    ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    ring->sqMapping = mmap(NULL, ring->sqMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    ring->cqMapping = (params.features & IORING_FEAT_SINGLE_MMAP) ? ring->sqMapping :
+                      mmap(NULL, ring->cqMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    ring->sqes = mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    ring->fd = fd;
+
+    if (ring->sqMapping == MAP_FAILED || ring->cqMapping == MAP_FAILED || ring->sqes == MAP_FAILED)
+    {
+        perror("Error mapping io_uring");
+        io_ring_free(ring);
+        return 0;
+    }
+
+    char* sq = (char*)ring->sqMapping;
+    char* cq = (char*)ring->cqMapping;
+    ring->sqTail = (unsigned*)(sq + params.sq_off.tail);
+    ring->sqMask = *(unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sqArray = (unsigned*)(sq + params.sq_off.array);
+    ring->cqHead = (unsigned*)(cq + params.cq_off.head);
+    ring->cqTail = (unsigned*)(cq + params.cq_off.tail);
+    ring->cqMask = *(unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    return 1;
+#else
+    (void)entries;
+    return 0;
+#endif
+}
+
+/**************************************************************************************
+ *                                IO RING FREE
+ **************************************************************************************/
+void io_ring_free(io_ring* ring)
+{
+#ifdef HAVE_IO_URING
+    if (ring->sqes != NULL && ring->sqes != MAP_FAILED)
+    {
+        munmap(ring->sqes, ring->sqesSize);
+    }
+    if (ring->cqMapping != NULL && ring->cqMapping != MAP_FAILED && ring->cqMapping != ring->sqMapping)
+    {
+        munmap(ring->cqMapping, ring->cqMappingSize);
+    }
+    if (ring->sqMapping != NULL && ring->sqMapping != MAP_FAILED)
+    {
+        munmap(ring->sqMapping, ring->sqMappingSize);
+    }
+#endif
+    if (ring->fd >= 0)
+    {
+        close(ring->fd);
+    }
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+}
+
+/**************************************************************************************
+ *                               IO RING SUBMIT
+ **************************************************************************************/
+int io_ring_submit(io_ring* ring, unsigned count, uint64_t* callCount)
+{
+#ifdef HAVE_IO_URING
+    unsigned tail = *ring->sqTail;
+    int isOk = 1;
+
+    /*Publish the entries, one system call submits them and waits for all of them*/
+    __atomic_store_n(ring->sqTail, tail + count, __ATOMIC_RELEASE);
+    long submitted;
+    do
+    {
+        submitted = syscall(__NR_io_uring_enter, ring->fd, count, count, IORING_ENTER_GETEVENTS, NULL, 0);
+        (*callCount)++;
+    } while (submitted < 0 && errno == EINTR);
+
+    /*The kernel takes the entries in order: the ones it did not take are run here, after the
+      ones it took are complete, and the ring is not used any more*/
+    unsigned takenCount = count;
+    if (submitted < 0)
+    {
+        perror("Error submitting to io_uring");
+        takenCount = 0;
+    }
+    else if (submitted < (long)count)
+    {
+        fprintf(stderr, "io_uring took %ld of %u operations\n", submitted, count);
+        takenCount = (unsigned)submitted;
+    }
+
+    /*Reap the completions: a write must be complete, a sync must return 0 (the first error is kept)*/
+    unsigned head = *ring->cqHead;
+    unsigned reapCount = takenCount;
+    while (reapCount > 0)
+    {
+        unsigned completedTail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+        if (head == completedTail)
+        {
+            if (syscall(__NR_io_uring_enter, ring->fd, 0, reapCount, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR)
+            {
+                perror("Error waiting for io_uring");
+                return 0;
+            }
+            (*callCount)++;
+            continue;
+        }
+
+        for (; head != completedTail && reapCount > 0; head++, reapCount--)
+        {
+            const struct io_uring_cqe* cqe = &ring->cqes[head & ring->cqMask];
+            if (isOk && (cqe->res < 0 || (uint64_t)cqe->res != cqe->user_data))
+            {
+                errno = (cqe->res < 0) ? -cqe->res : EIO;
+                isOk = 0;
+            }
+        }
+        __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+    }
+
+    if (takenCount == count)
+    {
+        return isOk;
+    }
+
+    for (unsigned i = takenCount; i < count; i++)
+    {
+        const struct io_uring_sqe* sqe = &ring->sqes[(tail + i) & ring->sqMask];
+        if (sqe->opcode == IORING_OP_WRITEV)
+        {
+            isOk &= (pwritev(sqe->fd, (const struct iovec*)(uintptr_t)sqe->addr, (int)sqe->len, (off_t)sqe->off) == (ssize_t)sqe->user_data);
+        }
+        else
+        {
+            isOk &= (((sqe->fsync_flags & IORING_FSYNC_DATASYNC) ? fdatasync(sqe->fd) : fsync(sqe->fd)) == 0);
+        }
+        (*callCount)++;
+    }
+    return isOk ? -1 : 0;
+#else
+    (void)ring;
+    (void)count;
+    (void)callCount;
+    return 0;
+#endif
+}
+
+/**************************************************************************************
+ *                                LOG RING CLOSE
+ **************************************************************************************/
+void log_ring_close(void)
+{
+    if (s_log_ring_fd >= 0)
+    {
+        close(s_log_ring_fd);
+    }
+    s_log_ring_fd = -1;
+    s_log_ring_capacity = 0;
+    s_log_ring_next = 1;
+}
+
+/**************************************************************************************
+ *                                LOG RING LOAD
+ **************************************************************************************/
+long log_ring_load(game_history* history)
+{
+    game_history_clear(history);
+
+    if (!log_ring_open(history->capacity))
+    {
+        return -1;
+    }
+
+    size_t mappingSize;
+    log_record* slots = log_ring_map_slots(s_log_ring_fd, s_log_ring_capacity, 0, &mappingSize);
+    if (slots == NULL)
+    {
+        return -1;
+    }
+
+    /*Insert the games oldest first, the history keeps the newest ones*/
+    uint64_t lastSequence = s_log_ring_next - 1;
+    uint64_t firstSequence = (lastSequence > s_log_ring_capacity) ? lastSequence - s_log_ring_capacity + 1 : 1;
+    long count = 0;
+
+    for (uint64_t sequence = firstSequence; sequence <= lastSequence; sequence++)
+    {
+        const log_record* record = &slots[sequence % s_log_ring_capacity];
+        if (record->sequence == sequence)
+        {
+            log_record_to_entry(record, game_history_push(history));
+            count++;
+        }
+    }
+
+    log_ring_unmap_slots(slots, mappingSize);
+    return count;
+}
+
+/**************************************************************************************
+ *                           LOG RING REPLAY PENDING
+ **************************************************************************************/
+long log_ring_replay_pending(pending_index* index)
+{
+    if (!log_ring_open(GAME_HISTORY_DEFAULT_CAPACITY))
+    {
+        return -1;
+    }
+
+    /*An index ahead of the ring file has games the file lost, one behind the oldest game
+      missed games the file does not keep: rebuild it from the games of the file*/
+    uint64_t lastSequence = s_log_ring_next - 1;
+    uint64_t firstSequence = (lastSequence > s_log_ring_capacity) ? lastSequence - s_log_ring_capacity + 1 : 1;
+    uint64_t appliedSequence = index->appliedSequence;
+
+    if (appliedSequence > lastSequence || appliedSequence + 1 < firstSequence)
+    {
+        pending_index_clear(index);
+        appliedSequence = firstSequence - 1;
+    }
+    if (appliedSequence == lastSequence)
+    {
+        return 0;
+    }
+
+    size_t mappingSize;
+    log_record* slots = log_ring_map_slots(s_log_ring_fd, s_log_ring_capacity, 0, &mappingSize);
+    if (slots == NULL)
+    {
+        return -1;
+    }
+
+    long count = 0;
+    for (uint64_t sequence = appliedSequence + 1; sequence <= lastSequence; sequence++)
+    {
+        const log_record* record = &slots[sequence % s_log_ring_capacity];
+        if (record->sequence == sequence && pending_index_apply(index, record))
+        {
+            count++;
+        }
+    }
+
+    log_ring_unmap_slots(slots, mappingSize);
+    pending_index_sync(index);
+    return count;
+}
+
+/**************************************************************************************
+ *                           PERSIST WRITER ADD FAILED
+ **************************************************************************************/
+static void persist_writer_add_failed(persist_writer* writer, uint64_t first, uint64_t last)
+{
+    int count = writer->failedRangeCount;
+
+    if (count > 0 && writer->failedLast[count - 1] + 1 == first)
+    {
+        writer->failedLast[count - 1] = last;
+        return;
+    }
+
+    /*Full: the two oldest ranges become one*/
+    if (count == PERSIST_FAILED_RANGES)
+    {
+        writer->failedLast[0] = writer->failedLast[1];
+        memmove(&writer->failedFirst[1], &writer->failedFirst[2], (size_t)(count - 2) * sizeof(uint64_t));
+        memmove(&writer->failedLast[1], &writer->failedLast[2], (size_t)(count - 2) * sizeof(uint64_t));
+        count--;
+    }
+
+    writer->failedFirst[count] = first;
+    writer->failedLast[count] = last;
+    writer->failedRangeCount = count + 1;
+}
+
+/**************************************************************************************
+ *                            PERSIST WRITER IS SAVED
+ **************************************************************************************/
+static int persist_writer_is_saved(const persist_writer* writer, uint64_t ticket)
+{
+    if (writer->durableCount < ticket)
+    {
+        return 0;
+    }
+
+    for (int i = writer->failedRangeCount - 1; i >= 0 && writer->failedLast[i] >= ticket; i--)
+    {
+        if (writer->failedFirst[i] <= ticket)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**************************************************************************************
+ *                              PERSIST WRITER RUN
+ **************************************************************************************/
+static void* persist_writer_run(void* arg)
+{
+    persist_writer* writer = (persist_writer*)arg;
+    const persist_options* options = &writer->options;
+
+    /*The io_uring belongs to this thread, pwrite is used when it cannot be created*/
+    writer->isRingReady = (options->io == PERSIST_IO_URING) && io_ring_init(&writer->ring, IO_RING_ENTRIES);
+
+    pthread_mutex_lock(&writer->mutex);
+    for (;;)
+    {
+        while (writer->count == 0 && !writer->isPlayerTableDirty && !writer->isStopping)
+        {
+            pthread_cond_wait(&writer->wakeup, &writer->mutex);
+        }
+        if (writer->count == 0 && !writer->isPlayerTableDirty)
+        {
+            break;
+        }
+
+        /*Group commit: let the other sessions join the batch, one sync covers all of them*/
+        if (options->mode != PERSIST_SYNC_NONE && writer->count > 0 && options->intervalMs > 0)
+        {
+            struct timespec deadline;
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_sec += options->intervalMs / 1000;
+            deadline.tv_nsec += (options->intervalMs % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L)
+            {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+
+            while (writer->count < (size_t)options->batchSize && !writer->isStopping)
+            {
+                if (pthread_cond_timedwait(&writer->wakeup, &writer->mutex, &deadline) == ETIMEDOUT)
+                {
+                    break;
+                }
+            }
+        }
+
+        /*Take every queued update at once, the sessions can queue again meanwhile*/
+        size_t count = writer->count;
+        for (size_t i = 0; i < count; i++)
+        {
+            writer->batch[i] = writer->records[(writer->head + i) % PERSIST_QUEUE_CAPACITY];
+        }
+        writer->head = (writer->head + count) % PERSIST_QUEUE_CAPACITY;
+        writer->count = 0;
+        int isTableDirty = writer->isPlayerTableDirty;
+        writer->isPlayerTableDirty = 0;
+        writer->isBusy = 1;
+        pthread_cond_broadcast(&writer->progress);
+        pthread_mutex_unlock(&writer->mutex);
+
+        /*The writes of the batch: io_uring (slots taken under the file mutex, written after it) or pwrite*/
+        int isSynced = (options->mode != PERSIST_SYNC_NONE);
+        int isWritten = 1;
+        int operationCount = 0;
+        int syncFd = -1;
+        uint64_t ioCallCount = 0;
+        double syncTime = 0.0;
+        if (count > 0)
+        {
+            pthread_mutex_lock(&s_file_mutex);
+            if (writer->isRingReady)
+            {
+                operationCount = log_ring_prepare(&writer->ring, writer->batch, count, isSynced);
+            }
+
+            /*Without io_uring: pwrite, then fdatasync*/
+            if (operationCount == 0)
+            {
+                int writeCount = log_ring_write(writer->batch, count);
+                ioCallCount += writeCount;
+                isWritten = (writeCount > 0);
+                if (writeCount > 0 && isSynced)
+                {
+                    syncFd = s_log_ring_fd;
+                }
+            }
+            pthread_mutex_unlock(&s_file_mutex);
+        }
+
+        /*The ring file stays open, the other writers append while this one syncs*/
+        double startTime = get_time_seconds();
+        int ringResult = 0;
+        if (operationCount > 0)
+        {
+            ringResult = io_ring_submit(&writer->ring, (unsigned)operationCount, &ioCallCount);
+            if (ringResult == 0)
+            {
+                perror("Error writing file");
+                isWritten = 0;
+
+                /*The next games take the slots again, like after a failed pwrite*/
+                pthread_mutex_lock(&s_file_mutex);
+                log_ring_release(writer->batch, count);
+                pthread_mutex_unlock(&s_file_mutex);
+            }
+        }
+        else if (syncFd >= 0)
+        {
+            if (fdatasync(syncFd) < 0)
+            {
+                perror("Error syncing file");
+                isWritten = 0;
+            }
+            ioCallCount++;
+        }
+        syncTime = get_time_seconds() - startTime;
+
+        /*The index file follows the ring file: it gets the records once they are written*/
+        if (count > 0 && isWritten)
+        {
+            pthread_mutex_lock(&s_file_mutex);
+            for (size_t i = 0; i < count; i++)
+            {
+                pending_index_apply(&s_pending_file_index, &writer->batch[i]);
+            }
+            pending_index_sync(&s_pending_file_index);
+            pthread_mutex_unlock(&s_file_mutex);
+        }
+
+        /*After a refused submission or a failed write the next batches use pwrite*/
+        if (operationCount > 0 && ringResult != 1)
+        {
+            io_ring_free(&writer->ring);
+            writer->isRingReady = 0;
+        }
+
+        /*Copy the table under the store mutex, write it without*/
+        int isTableSaved = 0;
+        if (isTableDirty)
+        {
+            pthread_mutex_lock(writer->storeMutex);
+            isTableSaved = player_table_copy(&writer->snapshot, writer->topPlayers);
+            pthread_mutex_unlock(writer->storeMutex);
+
+            /*The image goes through the ring of the writer too, a ring that failed is not used again*/
+            if (isTableSaved && player_table_save(&writer->snapshot, writer->isRingReady ? &writer->ring : NULL) != 1 &&
+                writer->isRingReady)
+            {
+                io_ring_free(&writer->ring);
+                writer->isRingReady = 0;
+            }
+        }
+
+        pthread_mutex_lock(&writer->mutex);
+        if (count > 0)
+        {
+            int bucket = 0;
+            while (bucket < PERSIST_BATCH_BUCKETS - 1 && ((size_t)2 << bucket) <= count)
+            {
+                bucket++;
+            }
+            writer->stats.batchSizes[bucket]++;
+            writer->stats.batchCount++;
+            if (count > writer->stats.maxBatch)
+            {
+                writer->stats.maxBatch = count;
+            }
+        }
+        writer->stats.recordCount += count;
+        writer->stats.ringBatchCount += (ringResult > 0);
+        writer->stats.ioCallCount += ioCallCount;
+        if (count > 0 && isSynced)
+        {
+            writer->stats.syncCount++;
+            writer->stats.syncSeconds += syncTime;
+        }
+        writer->stats.tableSaveCount += isTableSaved;
+        writer->stats.failedBatchCount += (count > 0 && !isWritten);
+
+        /*A failed batch is never saved (a later sync does not bring its writes back), the
+          later batches are*/
+        if (isWritten)
+        {
+            writer->durableCount = writer->writtenCount + count;
+        }
+        else if (count > 0)
+        {
+            persist_writer_add_failed(writer, writer->writtenCount + 1, writer->writtenCount + count);
+        }
+        writer->writtenCount += count;
+        writer->isBusy = 0;
+        pthread_cond_broadcast(&writer->progress);
+        if (count > 0 && writer->notify != NULL)
+        {
+            writer->notify(writer->notifyContext);
+        }
+    }
+    pthread_mutex_unlock(&writer->mutex);
+
+    if (writer->isRingReady)
+    {
+        io_ring_free(&writer->ring);
+        writer->isRingReady = 0;
+    }
+
+    return NULL;
+}
+
+/**************************************************************************************
+ *                             PERSIST WRITER START
+ **************************************************************************************/
+persist_writer* persist_writer_start(game_store* store)
+{
+    persist_writer* writer = calloc(1, sizeof(persist_writer));
+    if (writer == NULL)
+    {
+        perror("Error allocating writer");
+        return NULL;
+    }
+
+    /*The batch deadline is taken from the monotonic clock*/
+    pthread_condattr_t attributes;
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    pthread_mutex_init(&writer->mutex, NULL);
+    pthread_cond_init(&writer->wakeup, &attributes);
+    pthread_cond_init(&writer->progress, NULL);
+    pthread_condattr_destroy(&attributes);
+    writer->topPlayers = &store->topPlayers;
+    writer->storeMutex = &store->mutex;
+    writer->options = s_persist_options;
+
+    if (pthread_create(&writer->thread, NULL, persist_writer_run, writer) != 0)
+    {
+        perror("Error creating writer thread");
+        pthread_cond_destroy(&writer->progress);
+        pthread_cond_destroy(&writer->wakeup);
+        pthread_mutex_destroy(&writer->mutex);
+        free(writer);
+        return NULL;
+    }
+
+    return writer;
+}
+
+/**************************************************************************************
+ *                             PERSIST WRITER PUSH
+ **************************************************************************************/
+uint64_t persist_writer_push(persist_writer* writer, const log_record* record, int isWin)
+{
+    pthread_mutex_lock(&writer->mutex);
+
+    /*Full queue: wait until the writer takes its batch*/
+    if (writer->count == PERSIST_QUEUE_CAPACITY)
+    {
+        writer->stats.fullWaitCount++;
+        while (writer->count == PERSIST_QUEUE_CAPACITY)
+        {
+            pthread_cond_wait(&writer->progress, &writer->mutex);
+        }
+    }
+
+    writer->records[(writer->head + writer->count) % PERSIST_QUEUE_CAPACITY] = *record;
+    writer->count++;
+    uint64_t ticket = ++writer->queuedCount;
+    if (isWin)
+    {
+        writer->isPlayerTableDirty = 1;
+        writer->stats.winCount++;
+    }
+
+    /*Wake the writer for the first record, and when a gathered batch is complete*/
+    if (writer->count == 1 || writer->count == (size_t)writer->options.batchSize)
+    {
+        pthread_cond_signal(&writer->wakeup);
+    }
+    pthread_mutex_unlock(&writer->mutex);
+
+    return ticket;
+}
+
+/**************************************************************************************
+ *                             PERSIST WRITER WAIT
+ **************************************************************************************/
+int persist_writer_wait(persist_writer* writer, uint64_t ticket)
+{
+    pthread_mutex_lock(&writer->mutex);
+    if (writer->writtenCount < ticket)
+    {
+        writer->stats.commitWaitCount++;
+        while (writer->writtenCount < ticket)
+        {
+            pthread_cond_wait(&writer->progress, &writer->mutex);
+        }
+    }
+    int isSaved = persist_writer_is_saved(writer, ticket);
+    pthread_mutex_unlock(&writer->mutex);
+
+    return isSaved;
+}
+
+/**************************************************************************************
+ *                             PERSIST WRITER CHECK
+ **************************************************************************************/
+int persist_writer_check(persist_writer* writer, uint64_t ticket)
+{
+    pthread_mutex_lock(&writer->mutex);
+    int status = (writer->writtenCount < ticket) ? -1 : persist_writer_is_saved(writer, ticket);
+    pthread_mutex_unlock(&writer->mutex);
+
+    return status;
+}
+
+/**************************************************************************************
+ *                           PERSIST WRITER SET NOTIFY
+ **************************************************************************************/
+void persist_writer_set_notify(persist_writer* writer, void (*notify)(void* context), void* context)
+{
+    pthread_mutex_lock(&writer->mutex);
+    writer->notify = notify;
+    writer->notifyContext = context;
+    pthread_mutex_unlock(&writer->mutex);
+}
+
+/**************************************************************************************
+ *                             PERSIST WRITER FLUSH
+ **************************************************************************************/
+void persist_writer_flush(persist_writer* writer)
+{
+    pthread_mutex_lock(&writer->mutex);
+    while (writer->count > 0 || writer->isPlayerTableDirty || writer->isBusy)
+    {
+        pthread_cond_wait(&writer->progress, &writer->mutex);
+    }
+    pthread_mutex_unlock(&writer->mutex);
+}
+
+/**************************************************************************************
+ *                             PERSIST WRITER STOP
+ **************************************************************************************/
+void persist_writer_stop(persist_writer* writer)
+{
+    /*The writer drains the queue before it stops*/
+    pthread_mutex_lock(&writer->mutex);
+    writer->isStopping = 1;
+    pthread_cond_signal(&writer->wakeup);
+    pthread_mutex_unlock(&writer->mutex);
+
+    pthread_join(writer->thread, NULL);
+
+    /*Add the counters to the process totals*/
+    pthread_mutex_lock(&s_file_mutex);
+    s_persist_stats.recordCount += writer->stats.recordCount;
+    s_persist_stats.batchCount += writer->stats.batchCount;
+    if (writer->stats.maxBatch > s_persist_stats.maxBatch)
+    {
+        s_persist_stats.maxBatch = writer->stats.maxBatch;
+    }
+    for (int i = 0; i < PERSIST_BATCH_BUCKETS; i++)
+    {
+        s_persist_stats.batchSizes[i] += writer->stats.batchSizes[i];
+    }
+    s_persist_stats.syncCount += writer->stats.syncCount;
+    s_persist_stats.syncSeconds += writer->stats.syncSeconds;
+    s_persist_stats.winCount += writer->stats.winCount;
+    s_persist_stats.tableSaveCount += writer->stats.tableSaveCount;
+    s_persist_stats.fullWaitCount += writer->stats.fullWaitCount;
+    s_persist_stats.commitWaitCount += writer->stats.commitWaitCount;
+    s_persist_stats.ringBatchCount += writer->stats.ringBatchCount;
+    s_persist_stats.ioCallCount += writer->stats.ioCallCount;
+    s_persist_stats.failedBatchCount += writer->stats.failedBatchCount;
+    pthread_mutex_unlock(&s_file_mutex);
+
+    player_table_free(&writer->snapshot);
+    pthread_cond_destroy(&writer->progress);
+    pthread_cond_destroy(&writer->wakeup);
+    pthread_mutex_destroy(&writer->mutex);
+    free(writer);
+}
+
+/**************************************************************************************
+ *                              PERSIST STATS READ
+ **************************************************************************************/
+void persist_stats_read(persist_stats* stats)
+{
+    pthread_mutex_lock(&s_file_mutex);
+    *stats = s_persist_stats;
+    pthread_mutex_unlock(&s_file_mutex);
+}
+
+/**************************************************************************************
+ *                              PERSIST STATS PRINT
+ **************************************************************************************/
+void persist_stats_print(const persist_stats* stats)
+{
+
+    if (s_persist_options.mode == PERSIST_SYNC_NONE)
+    {
+        printf("Sync            : none\n");
+    }
+    else
+    {
+        printf("Sync            : %s (interval %ld ms, batch %ld)\n", s_persist_sync_mode_names[s_persist_options.mode],
+               s_persist_options.intervalMs, s_persist_options.batchSize);
+    }
+    printf("Records written : %llu in %llu batches (avg %.1f, max %llu)\n", (unsigned long long)stats->recordCount,
+           (unsigned long long)stats->batchCount, stats->batchCount ? (double)stats->recordCount / stats->batchCount : 0.0,
+           (unsigned long long)stats->maxBatch);
+
+    /*Batch size histogram, power of two buckets*/
+    printf("Batch sizes     :");
+    for (int i = 0; i < PERSIST_BATCH_BUCKETS; i++)
+    {
+        if (stats->batchSizes[i] == 0)
+        {
+            continue;
+        }
+        if (i == 0)
+        {
+            printf(" 1:%llu", (unsigned long long)stats->batchSizes[i]);
+        }
+        else if (i == PERSIST_BATCH_BUCKETS - 1)
+        {
+            printf(" %d+:%llu", 1 << i, (unsigned long long)stats->batchSizes[i]);
+        }
+        else
+        {
+            printf(" %d-%d:%llu", 1 << i, (2 << i) - 1, (unsigned long long)stats->batchSizes[i]);
+        }
+    }
+    printf("\n");
+
+    printf("I/O backend     : %s (%llu of %llu batches through io_uring)\n", s_persist_io_names[s_persist_options.io],
+           (unsigned long long)stats->ringBatchCount, (unsigned long long)stats->batchCount);
+    printf("I/O calls       : %llu (%.2f per batch)\n", (unsigned long long)stats->ioCallCount,
+           stats->batchCount ? (double)stats->ioCallCount / stats->batchCount : 0.0);
+    printf("Syncs           : %llu (avg %.3f ms)\n", (unsigned long long)stats->syncCount,
+           stats->syncCount ? stats->syncSeconds * 1e3 / stats->syncCount : 0.0);
+    printf("Table saves     : %llu for %llu wins\n", (unsigned long long)stats->tableSaveCount, (unsigned long long)stats->winCount);
+    printf("Session waits   : %llu on a full queue, %llu for a sync\n", (unsigned long long)stats->fullWaitCount,
+           (unsigned long long)stats->commitWaitCount);
+    if (stats->failedBatchCount > 0)
+    {
+        printf("Failed batches  : %llu (their games are not saved)\n", (unsigned long long)stats->failedBatchCount);
+    }
+}
+
+/**************************************************************************************
+ *                               USER NAME HASH
+ **************************************************************************************/
+uint64_t user_name_hash(const char* userName)
+{
+    /*FNV-1a, the values 0 and 1 mark the empty and removed slots*/
+    uint64_t hash = 14695981039346656037ull;
+
+    for (const unsigned char* c = (const unsigned char*)userName; *c != '\0'; c++)
+    {
+        hash ^= *c;
+        hash *= 1099511628211ull;
+    }
+
+    return (hash < PENDING_SLOT_REMOVED + 1) ? hash + PENDING_SLOT_REMOVED + 1 : hash;
+}
+
+/**************************************************************************************
+ *                              PENDING INDEX MAP
+ **************************************************************************************/
+static int pending_index_map(pending_index* index, const char* path, uint64_t capacity)
+{
+    size_t mappingSize = sizeof(pending_index_header) + capacity * sizeof(pending_slot);
+    int fd = -1;
+    void* mapping;
+
+    /*A new table of empty slots, backed by the file or by memory only*/
+    if (path != NULL)
+    {
+        fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0 || ftruncate(fd, (off_t)mappingSize) < 0)
+        {
+            perror("Error opening file");
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+            return 0;
+        }
+        mapping = mmap(NULL, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    else
+    {
+        mapping = mmap(NULL, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+
+    if (mapping == MAP_FAILED)
+    {
+        perror("Error mapping index");
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return 0;
+    }
+
+    index->header = (pending_index_header*)mapping;
+    index->slots = (pending_slot*)((char*)mapping + sizeof(pending_index_header));
+    index->mappingSize = mappingSize;
+    index->fd = fd;
+
+    memcpy(index->header->magic, PENDING_INDEX_MAGIC, sizeof(index->header->magic));
+    index->header->version = PENDING_INDEX_VERSION;
+    index->header->slotSize = sizeof(pending_slot);
+    index->header->capacity = capacity;
+    index->header->count = 0;
+    index->header->usedCount = 0;
+    index->header->appliedSequence = 0;
+    index->appliedSequence = 0;
+    return 1;
+}
+
+/**************************************************************************************
+ *                              PENDING INDEX UNMAP
+ **************************************************************************************/
+static void pending_index_unmap(pending_index* index)
+{
+    if (index->header != NULL)
+    {
+        munmap(index->header, index->mappingSize);
+    }
+    if (index->fd >= 0)
+    {
+        close(index->fd);
+    }
+
+    index->header = NULL;
+    index->slots = NULL;
+    index->fd = -1;
+}
+
+/**************************************************************************************
+ *                              PENDING INDEX PROBE
+ **************************************************************************************/
+static pending_slot* pending_index_probe(const pending_index* index, const char* userName, uint64_t hash, int isInsert)
+{
+    uint64_t mask = index->header->capacity - 1;
+    pending_slot* removedSlot = NULL;
+
+    /*Linear probing, the table is never full*/
+    for (uint64_t i = hash & mask; ; i = (i + 1) & mask)
+    {
+        pending_slot* slot = &index->slots[i];
+
+        if (slot->hash == PENDING_SLOT_EMPTY)
+        {
+            return isInsert ? ((removedSlot != NULL) ? removedSlot : slot) : NULL;
+        }
+        if (slot->hash == PENDING_SLOT_REMOVED)
+        {
+            if (removedSlot == NULL)
+            {
+                removedSlot = slot;
+            }
+        }
+        else if (slot->hash == hash && strcmp(slot->userName, userName) == 0)
+        {
+            return slot;
+        }
+    }
+}
+
+/**************************************************************************************
+ *                             PENDING INDEX REHASH
+ **************************************************************************************/
+static int pending_index_rehash(pending_index* index, uint64_t capacity)
+{
+    pending_index newIndex;
+    char tmpPath[64];
+    const char* newPath = NULL;
+
+    if (index->path != NULL)
+    {
+        snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", index->path);
+        newPath = tmpPath;
+    }
+
+    if (!pending_index_map(&newIndex, newPath, capacity))
+    {
+        return 0;
+    }
+
+    /*Move the pending games, the removed slots are dropped*/
+    for (uint64_t i = 0; i < index->header->capacity; i++)
+    {
+        const pending_slot* slot = &index->slots[i];
+
+        if (slot->hash > PENDING_SLOT_REMOVED)
+        {
+            *pending_index_probe(&newIndex, slot->userName, slot->hash, 1) = *slot;
+            newIndex.header->count++;
+            newIndex.header->usedCount++;
+        }
+    }
+    newIndex.header->appliedSequence = index->header->appliedSequence;
+    newIndex.appliedSequence = index->appliedSequence;
+
+    if (newPath != NULL && !file_replace(newIndex.fd, newPath, index->path))
+    {
+        pending_index_unmap(&newIndex);
+        return 0;
+    }
+
+    newIndex.path = index->path;
+    pending_index_unmap(index);
+    *index = newIndex;
+    return 1;
+}
+
+/**************************************************************************************
+ *                              PENDING INDEX OPEN
+ **************************************************************************************/
+int pending_index_open(pending_index* index, const char* path)
+{
+    memset(index, 0, sizeof(*index));
+    index->fd = -1;
+    index->path = path;
+
+    if (path != NULL)
+    {
+        int fd = open(path, O_RDWR | O_CLOEXEC);
+        struct stat fileStat;
+
+        if (fd >= 0 && fstat(fd, &fileStat) == 0 && (size_t)fileStat.st_size >= sizeof(pending_index_header))
+        {
+            void* mapping = mmap(NULL, (size_t)fileStat.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            const pending_index_header* header = (mapping != MAP_FAILED) ? (const pending_index_header*)mapping : NULL;
+
+            /*Use the saved table when the format and the size match*/
+            if (header != NULL &&
+                memcmp(header->magic, PENDING_INDEX_MAGIC, sizeof(header->magic)) == 0 &&
+                header->version == PENDING_INDEX_VERSION &&
+                header->slotSize == sizeof(pending_slot) &&
+                header->capacity >= PENDING_INDEX_MIN_CAPACITY &&
+                (header->capacity & (header->capacity - 1)) == 0 &&
+                (size_t)fileStat.st_size == sizeof(pending_index_header) + header->capacity * sizeof(pending_slot))
+            {
+                index->header = (pending_index_header*)mapping;
+                index->slots = (pending_slot*)((char*)mapping + sizeof(pending_index_header));
+                index->mappingSize = (size_t)fileStat.st_size;
+                index->fd = fd;
+                index->appliedSequence = index->header->appliedSequence;
+                return 1;
+            }
+
+            fprintf(stderr, "%s has an unknown format, starting a new index\n", path);
+            if (mapping != MAP_FAILED)
+            {
+                munmap(mapping, (size_t)fileStat.st_size);
+            }
+        }
+
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+
+    return pending_index_map(index, path, PENDING_INDEX_MIN_CAPACITY);
+}
+
+/**************************************************************************************
+ *                             PENDING INDEX CLOSE
+ **************************************************************************************/
+void pending_index_close(pending_index* index)
+{
+    if (index->header != NULL)
+    {
+        pending_index_sync(index);
+    }
+    pending_index_unmap(index);
+}
+
+/**************************************************************************************
+ *                              PENDING INDEX SYNC
+ **************************************************************************************/
+void pending_index_sync(pending_index* index)
+{
+    /*The slots first: the kernel may write the header page at any time*/
+    if (index->fd >= 0 && s_persist_options.mode != PERSIST_SYNC_NONE &&
+        index->header->appliedSequence != index->appliedSequence &&
+        msync(index->header, index->mappingSize, MS_SYNC) < 0)
+    {
+        perror("Error syncing index");
+        return;
+    }
+
+    index->header->appliedSequence = index->appliedSequence;
+}
+
+/**************************************************************************************
+ *                              PENDING INDEX FIND
+ **************************************************************************************/
+const pending_slot* pending_index_find(const pending_index* index, const char* userName)
+{
+    return pending_index_probe(index, userName, user_name_hash(userName), 0);
+}
+
+/**************************************************************************************
+ *                              PENDING INDEX PUT
+ **************************************************************************************/
+int pending_index_put(pending_index* index, User user, const packed_digits* magicNumber, digit_mask commonMask, int digitCount)
+{
+    uint64_t hash = user_name_hash(user.userName);
+    pending_slot* slot = pending_index_probe(index, user.userName, hash, 0);
+    int isNew = 0;
+    int isEmptySlot = 0;
+
+    if (slot == NULL)
+    {
+        /*Keep the load factor under 70%, grow when the table holds pending games*/
+        if ((index->header->usedCount + 1) * 10 > index->header->capacity * 7)
+        {
+            uint64_t capacity = index->header->capacity;
+            if ((index->header->count + 1) * 10 > capacity * 3)
+            {
+                capacity *= 2;
+            }
+            if (!pending_index_rehash(index, capacity))
+            {
+                return 0;
+            }
+        }
+
+        slot = pending_index_probe(index, user.userName, hash, 1);
+        isEmptySlot = (slot->hash == PENDING_SLOT_EMPTY);
+        isNew = 1;
+
+        memset(slot->userName, '\0', sizeof(slot->userName));
+        strcpy(slot->userName, user.userName);
+    }
+
+    /*Write the game before the hash, so a slot is never valid with a partial game*/
+    slot->magicNumber = *magicNumber;
+    slot->commonMask = commonMask;
+    slot->digitCount = (uint8_t)digitCount;
+    slot->totalGuess = user.totalGuess;
+    slot->rightGuess = user.rightGuess;
+    slot->timeRecord = user.timeRecord;
+    slot->hash = hash;
+
+    if (isNew)
+    {
+        index->header->count++;
+        index->header->usedCount += isEmptySlot;
+    }
+    return 1;
+}
+
+/**************************************************************************************
+ *                             PENDING INDEX REMOVE
+ **************************************************************************************/
+void pending_index_remove(pending_index* index, const char* userName)
+{
+    pending_slot* slot = pending_index_probe(index, userName, user_name_hash(userName), 0);
+
+    if (slot != NULL)
+    {
+        slot->hash = PENDING_SLOT_REMOVED;
+        index->header->count--;
+    }
+}
+
+/**************************************************************************************
+ *                              PENDING INDEX CLEAR
+ **************************************************************************************/
+void pending_index_clear(pending_index* index)
+{
+    memset(index->slots, 0, index->header->capacity * sizeof(pending_slot));
+    index->header->count = 0;
+    index->header->usedCount = 0;
+    index->header->appliedSequence = 0;
+    index->appliedSequence = 0;
+}
+
+/**************************************************************************************
+ *                              PENDING INDEX APPLY
+ **************************************************************************************/
+int pending_index_apply(pending_index* index, const log_record* record)
+{
+    game_entry entry;
+    int isOk = 1;
+
+    log_record_to_entry(record, &entry);
+    if (entry.isAllCorrect)
+    {
+        pending_index_remove(index, entry.user.userName);
+    }
+    else if (strlen(entry.user.userName) > 0)
+    {
+        isOk = pending_index_put(index, entry.user, &entry.magicNumber, entry.commonMask, entry.digitCount);
+    }
+
+    /*The writers of several stores may finish their batches out of order*/
+    if (isOk && record->sequence > index->appliedSequence)
+    {
+        index->appliedSequence = record->sequence;
+    }
+    return isOk;
+}
+
+/**************************************************************************************
+ *                              PENDING INDEX COPY
+ **************************************************************************************/
+int pending_index_copy(pending_index* index, const pending_index* source)
+{
+    for (uint64_t i = 0; i < source->header->capacity; i++)
+    {
+        const pending_slot* slot = &source->slots[i];
+        User user;
+
+        if (slot->hash <= PENDING_SLOT_REMOVED)
+        {
+            continue;
+        }
+
+        memset(&user, 0, sizeof(user));
+        strcpy(user.userName, slot->userName);
+        user.totalGuess = slot->totalGuess;
+        user.rightGuess = slot->rightGuess;
+        user.timeRecord = slot->timeRecord;
+        if (!pending_index_put(index, user, &slot->magicNumber, slot->commonMask, slot->digitCount))
+        {
+            return 0;
+        }
+    }
+
+    index->appliedSequence = source->appliedSequence;
+    return 1;
+}
+
+/**************************************************************************************
+ *                        EXECUTION SIMULATION FUNCTION
+ **************************************************************************************/
+
+/**************************************************************************************
+ *                              RANDOM GUESSER
+ **************************************************************************************/
+void guesser_random(const char* commonChar, int guessCount, char* guess, unsigned int* seed)
+{
+    (void)guessCount;
+
+    int i;
+    for (i = 0; commonChar[i] != '\0'; i++)
+    {
+        /*Keep revealed digit, try a random one otherwise*/
+        guess[i] = (commonChar[i] != '_') ? commonChar[i] : (char)('0' + (rand_r(seed) % 10));
+    }
+    guess[i] = '\0';
+}
+
+/**************************************************************************************
+ *                              SWEEP GUESSER
+ **************************************************************************************/
+void guesser_sweep(const char* commonChar, int guessCount, char* guess, unsigned int* seed)
+{
+    (void)seed;
+
+    int i;
+    for (i = 0; commonChar[i] != '\0'; i++)
+    {
+        /*Keep revealed digit, try the digit of this round otherwise*/
+        guess[i] = (commonChar[i] != '_') ? commonChar[i] : (char)('0' + ((guessCount - 1) % 10));
+    }
+    guess[i] = '\0';
+}
+
+/**************************************************************************************
+ *                              GET TIME SECONDS
+ **************************************************************************************/
+double get_time_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**************************************************************************************
+ *                           RUN SIMULATION WORKER
+ **************************************************************************************/
+void* run_simulation_worker(void* arg)
+{
+    simulation_worker* worker = (simulation_worker*)arg;
+
+    /*Create instances owned by this worker, the session is headless (no output sink)*/
+    game_store ownStore;
+    game_store* store = worker->store;
+    game_session session;
+    char guess[LENGTH_NUMBER_MAX + 1];
+    char commonText[LENGTH_NUMBER_MAX + 1];
+
+    if (store == NULL)
+    {
+        if (!game_store_init(&ownStore, 0, worker->historyCapacity))
+        {
+            return NULL;
+        }
+        store = &ownStore;
+    }
+    game_session_init(&session, 0);
+    session.store = store;
+    session.digitCount = worker->digitCount;
+    session.rng = worker->rng;
+
+    /*The guessers use rand_r, seeded from the worker stream*/
+    unsigned int guesserSeed = (unsigned int)rng_next(&session.rng);
+
+    game_session_start(&session);
+
+    for (long game = 0; game < worker->gameCount; game++)
+    {
+        /*Create account and start game*/
+        game_step(&session, "1");
+        game_step(&session, "simulator");
+        game_step(&session, "2");
+
+        /*Guess magic number*/
+        while (session.state == GAME_STATE_PLAY)
+        {
+            /*Abandon the game, it is resumed by the next one*/
+            if (session.user.totalGuess > SIMULATION_MAX_GUESSES)
+            {
+                worker->totalGuesses += session.user.totalGuess - 1;
+                worker->totalRightGuesses += session.user.rightGuess;
+                worker->abandonedGames++;
+                game_step(&session, "quit");
+                break;
+            }
+
+            packed_digits_format(&session.magicNumber, session.commonMask, session.digitKernel->digitCount, commonText);
+            worker->guesser(commonText, session.user.totalGuess, guess, &guesserSeed);
+            game_step(&session, guess);
+        }
+
+        /*Answer the 10 highest table prompt*/
+        if (session.state == GAME_STATE_HIGH_SCORE)
+        {
+            worker->totalGuesses += session.user.totalGuess;
+            worker->totalRightGuesses += session.user.rightGuess;
+            game_step(&session, "n");
+        }
+    }
+
+    if (store == &ownStore)
+    {
+        game_store_close(&ownStore);
+    }
+    return NULL;
+}
+
+/**************************************************************************************
+ *                              RUN SIMULATION
+ **************************************************************************************/
+int run_simulation(int argc, char* argv[])
+{
+    long gameCount = 0;
+    long threadCount = 1;
+    guesser_fn guesser = guesser_sweep;
+    const char* guesserName = "sweep";
+    int isLogEnabled = 0;
+    long historyCapacity = GAME_HISTORY_DEFAULT_CAPACITY;
+    int digitCount = LENGTH_NUMBER;
+    uint64_t seed = (uint64_t)time(NULL);
+    int isSeedValid = 1;
+    int isPersistValid = 1;
+
+    /*Parse options*/
+    if (argc > 2)
+    {
+        gameCount = strtol(argv[2], NULL, 10);
+    }
+
+    for (int i = 3; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--guesser") == 0 && i + 1 < argc)
+        {
+            guesserName = argv[++i];
+            if (strcmp(guesserName, "sweep") == 0)
+            {
+                guesser = guesser_sweep;
+            }
+            else if (strcmp(guesserName, "random") == 0)
+            {
+                guesser = guesser_random;
+            }
+            else
+            {
+                fprintf(stderr, "Unknown guesser: %s\n", guesserName);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            threadCount = strtol(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--log") == 0)
+        {
+            isLogEnabled = 1;
+        }
+        else if (strcmp(argv[i], "--history") == 0 && i + 1 < argc)
+        {
+            historyCapacity = strtol(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--digits") == 0 && i + 1 < argc)
+        {
+            digitCount = parse_digit_count(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            isSeedValid = parse_seed(argv[++i], &seed);
+        }
+        else if (parse_persist_option(argc, argv, &i, &isPersistValid))
+        {
+            continue;
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (gameCount <= 0 || threadCount <= 0 || threadCount > SIMULATION_MAX_THREADS ||
+        historyCapacity <= 0 || historyCapacity > GAME_HISTORY_MAX_CAPACITY || digitCount == 0 || !isSeedValid || !isPersistValid)
+    {
+        fprintf(stderr, "Usage: %s --simulate <games> [--guesser sweep|random] [--threads 1..%d] [--log] [--history 1..%ld] [--digits %s] [--seed n]\n"
+                        "       " PERSIST_USAGE "\n",
+                argv[0], SIMULATION_MAX_THREADS, GAME_HISTORY_MAX_CAPACITY, DIGIT_COUNT_CHOICES);
+        return 1;
+    }
+
+    simulation_worker workers[SIMULATION_MAX_THREADS];
+    pthread_t threads[SIMULATION_MAX_THREADS];
+    rng_state stream;
+    static game_store sharedStore;
+
+    /*The files are loaded once and written by one writer, every worker adds its games to them*/
+    if (isLogEnabled && !game_store_init(&sharedStore, 1, (size_t)historyCapacity))
+    {
+        return 1;
+    }
+
+    /*Split the games, every worker gets the next 2^128 draws of the seed*/
+    rng_seed(&stream, seed);
+    memset(workers, 0, sizeof(workers));
+    for (long i = 0; i < threadCount; i++)
+    {
+        workers[i].gameCount = gameCount / threadCount + (i < gameCount % threadCount ? 1 : 0);
+        workers[i].guesser = guesser;
+        workers[i].digitCount = digitCount;
+        workers[i].historyCapacity = (size_t)historyCapacity;
+        workers[i].store = isLogEnabled ? &sharedStore : NULL;
+        workers[i].rng = stream;
+        rng_jump(&stream);
+    }
+
+    double startTime = get_time_seconds();
+
+    for (long i = 0; i < threadCount; i++)
+    {
+        if (pthread_create(&threads[i], NULL, run_simulation_worker, &workers[i]) != 0)
+        {
+            /*Run it on this thread instead*/
+            run_simulation_worker(&workers[i]);
+            threads[i] = pthread_self();
+        }
+    }
+
+    long totalGuesses = 0;
+    long totalRightGuesses = 0;
+    long abandonedGames = 0;
+
+    for (long i = 0; i < threadCount; i++)
+    {
+        if (!pthread_equal(threads[i], pthread_self()))
+        {
+            pthread_join(threads[i], NULL);
+        }
+        totalGuesses += workers[i].totalGuesses;
+        totalRightGuesses += workers[i].totalRightGuesses;
+        abandonedGames += workers[i].abandonedGames;
+    }
+
+    /*Write the last queued games and the exports*/
+    if (isLogEnabled)
+    {
+        game_store_close(&sharedStore);
+    }
+
+    double elapsedTime = get_time_seconds() - startTime;
+
+    /*Avoid division by zero on a very fast run*/
+    if (elapsedTime <= 0.0)
+    {
+        elapsedTime = 1e-9;
+    }
+
+    printf("SIMULATION REPORT\n");
+    printf("Guesser         : %s\n", guesserName);
+    printf("Digits          : %d\n", digitCount);
+    printf("Seed            : %llu\n", (unsigned long long)seed);
+    printf("Threads         : %ld\n", threadCount);
+    printf("Files           : %s\n", isLogEnabled ? "log + player table" : "disabled");
+    printf("Games           : %ld (abandoned: %ld)\n", gameCount, abandonedGames);
+    printf("Guesses         : %ld\n", totalGuesses);
+    printf("Avg guesses     : %.3f\n", (double)totalGuesses / gameCount);
+    printf("Avg right       : %.3f\n", (double)totalRightGuesses / gameCount);
+    printf("Elapsed         : %.3fs\n", elapsedTime);
+    printf("Games/sec       : %.0f\n", gameCount / elapsedTime);
+    printf("Guesses/sec     : %.0f\n", totalGuesses / elapsedTime);
+
+    /*Group commit counters of the worker stores*/
+    if (isLogEnabled)
+    {
+        persist_stats stats;
+        persist_stats_read(&stats);
+        persist_stats_print(&stats);
+    }
+
+    return 0;
+}
+
+/**************************************************************************************
+ *                        EXECUTION BENCHMARK FUNCTION
+ **************************************************************************************/
+
+/**************************************************************************************
+ *                           RUN COMPARE BENCHMARK
+ **************************************************************************************/
+int run_compare_benchmark(int argc, char* argv[])
+{
+    long pairCount = (argc > 2) ? strtol(argv[2], NULL, 10) : 1000000;
+    long rounds = (argc > 3) ? strtol(argv[3], NULL, 10) : 10;
+
+    if (pairCount <= 0 || rounds <= 0)
+    {
+        fprintf(stderr, "Usage: %s --bench-compare [pairs] [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    char* magicNumbers = malloc((size_t)pairCount * LENGTH_NUMBER);
+    char* inputNumbers = malloc((size_t)pairCount * LENGTH_NUMBER);
+    uint8_t* expectedMasks = malloc((size_t)pairCount);
+    uint8_t* matchMasks = malloc((size_t)pairCount);
+    uint8_t* isAllCorrect = malloc((size_t)pairCount);
+    packed_digits* packedMagicNumbers = malloc((size_t)pairCount * sizeof(packed_digits));
+    packed_digits* packedInputNumbers = malloc((size_t)pairCount * sizeof(packed_digits));
+
+    if (magicNumbers == NULL || inputNumbers == NULL || expectedMasks == NULL || matchMasks == NULL || isAllCorrect == NULL ||
+        packedMagicNumbers == NULL || packedInputNumbers == NULL)
+    {
+        perror("Error allocating benchmark");
+        free(magicNumbers);
+        free(inputNumbers);
+        free(packedMagicNumbers);
+        free(packedInputNumbers);
+        free(expectedMasks);
+        free(matchMasks);
+        free(isAllCorrect);
+        return 1;
+    }
+
+    /*Random pairs, a guess digit matches the magic digit one time out of 2*/
+    unsigned int seed = 12345;
+    for (long i = 0; i < pairCount * LENGTH_NUMBER; i++)
+    {
+        magicNumbers[i] = (char)('0' + rand_r(&seed) % 10);
+        inputNumbers[i] = (rand_r(&seed) % 2) ? magicNumbers[i] : (char)('0' + rand_r(&seed) % 10);
+    }
+    const digit_kernel* defaultKernel = digit_kernel_find(LENGTH_NUMBER);
+    for (long i = 0; i < pairCount; i++)
     {
-    case 1: 
+        defaultKernel->parse(magicNumbers + i * LENGTH_NUMBER, &packedMagicNumbers[i]);
+        defaultKernel->parse(inputNumbers + i * LENGTH_NUMBER, &packedInputNumbers[i]);
+    }
+
+    printf("COMPARE BENCHMARK\n");
+    printf("Pairs           : %ld x %ld rounds\n", pairCount, rounds);
+
+    /*Current path: one compare_2_string call per pair on a headless session*/
+    game_session session;
+    long correctCount = 0;
+    game_session_init(&session, 0);
+
+    double startTime = get_time_seconds();
+    for (long round = 0; round < rounds; round++)
+    {
+        for (long i = 0; i < pairCount; i++)
+        {
+            session.magicNumber = packedMagicNumbers[i];
+            session.inputNumber = packedInputNumbers[i];
+            session.commonMask = 0;
+            correctCount += compare_2_string(&session, &session.user);
+        }
+    }
+    double perCallTime = (get_time_seconds() - startTime) / (double)(pairCount * rounds);
+    printf("%-16s: %8.2f ns/pair\n", "compare_2_string", perCallTime * 1e9);
+
+    compare_batch_scalar(magicNumbers, inputNumbers, (size_t)pairCount, expectedMasks, NULL);
+
+    /*Word compare of the packed numbers used by compare_2_string, for every digit kernel*/
+    for (size_t k = 0; k < sizeof(s_digit_kernels) / sizeof(s_digit_kernels[0]); k++)
+    {
+        const digit_kernel* kernel = &s_digit_kernels[k];
+        char magicText[LENGTH_NUMBER_MAX];
+        char inputText[LENGTH_NUMBER_MAX];
+
+        /*The LENGTH_NUMBER pairs are the ones of the batch kernels, the other ones are drawn the same way*/
+        for (long i = 0; kernel != defaultKernel && i < pairCount; i++)
+        {
+            for (int d = 0; d < kernel->digitCount; d++)
+            {
+                magicText[d] = (char)('0' + rand_r(&seed) % 10);
+                inputText[d] = (rand_r(&seed) % 2) ? magicText[d] : (char)('0' + rand_r(&seed) % 10);
+            }
+            kernel->parse(magicText, &packedMagicNumbers[i]);
+            kernel->parse(inputText, &packedInputNumbers[i]);
+        }
+
+        startTime = get_time_seconds();
+        for (long round = 0; round < rounds; round++)
+        {
+            for (long i = 0; i < pairCount; i++)
+            {
+                matchMasks[i] = (uint8_t)kernel->match(&packedMagicNumbers[i], &packedInputNumbers[i]);
+            }
+        }
+        double packedTime = (get_time_seconds() - startTime) / (double)(pairCount * rounds);
+
+        char name[32];
+        snprintf(name, sizeof(name), "packed %d digits", kernel->digitCount);
+        printf("%-16s: %8.2f ns/pair (x%.1f)%s\n", name, packedTime * 1e9,
+               (packedTime > 0.0) ? perCallTime / packedTime : 0.0,
+               (kernel == defaultKernel && memcmp(matchMasks, expectedMasks, (size_t)pairCount) != 0) ? " MISMATCH" : "");
+    }
+
+    /*Every kernel supported by the CPU, checked against the scalar one*/
+    for (size_t k = 0; k < sizeof(s_compare_kernels) / sizeof(s_compare_kernels[0]); k++)
+    {
+        const compare_kernel* kernel = &s_compare_kernels[k];
+
+        if (!compare_kernel_is_supported(kernel))
+        {
+            printf("%-16s: not supported\n", kernel->name);
+            continue;
+        }
+
+        startTime = get_time_seconds();
+        for (long round = 0; round < rounds; round++)
+        {
+            kernel->function(magicNumbers, inputNumbers, (size_t)pairCount, matchMasks, isAllCorrect);
+        }
+        double batchTime = (get_time_seconds() - startTime) / (double)(pairCount * rounds);
+
+        int isSame = memcmp(matchMasks, expectedMasks, (size_t)pairCount) == 0;
+        printf("%-16s: %8.2f ns/pair (x%.1f)%s%s\n", kernel->name, batchTime * 1e9,
+               (batchTime > 0.0) ? perCallTime / batchTime : 0.0,
+               (kernel == compare_batch_kernel()) ? " [selected]" : "", isSame ? "" : " MISMATCH");
+    }
+
+    printf("All correct     : %ld\n", correctCount / rounds);
+
+    free(magicNumbers);
+    free(inputNumbers);
+    free(packedMagicNumbers);
+    free(packedInputNumbers);
+    free(expectedMasks);
+    free(matchMasks);
+    free(isAllCorrect);
+    return 0;
+}
+
+/**************************************************************************************
+ *                          MICRO BENCHMARK OPERATIONS
+ **************************************************************************************/
+static void micro_bench_random(micro_bench_context* context, long count)
+{
+    for (long i = 0; i < count; i++)
+    {
+        random_6_digits_number(&context->session);
+    }
+}
+
+static void micro_bench_check(micro_bench_context* context, long count)
+{
+    volatile int validCount = 0;
+    for (long i = 0; i < count; i++)
+    {
+        const char* text = context->inputTexts[context->cursor++ % MICRO_BENCH_POOL_SIZE];
+        validCount += check_6_digits_number(text, context->session.digitKernel);
+    }
+}
+
+static void micro_bench_compare(micro_bench_context* context, long count)
+{
+    for (long i = 0; i < count; i++)
+    {
+        context->session.inputNumber = context->inputNumbers[context->cursor++ % MICRO_BENCH_POOL_SIZE];
+        compare_2_string(&context->session, &context->session.user);
+    }
+}
+
+static void micro_bench_update_players(micro_bench_context* context, long count)
+{
+    for (long i = 0; i < count; i++)
+    {
+        update_player_table(&context->users[context->cursor++ % MICRO_BENCH_POOL_SIZE], &context->players);
+    }
+}
+
+static void micro_bench_save_players(micro_bench_context* context, long count)
+{
+    for (long i = 0; i < count; i++)
+    {
+        save_player_table_to_file(&context->players);
+    }
+}
+
+static void micro_bench_read_players(micro_bench_context* context, long count)
+{
+    (void)context;
+    for (long i = 0; i < count; i++)
+    {
+        player_table table;
+        player_table_init(&table);
+        read_player_table_from_file(&table);
+        player_table_free(&table);
+    }
+}
+
+static void micro_bench_export_players(micro_bench_context* context, long count)
+{
+    for (long i = 0; i < count; i++)
+    {
+        export_player_table_to_text(&context->players);
+    }
+}
+
+static void micro_bench_save_game(micro_bench_context* context, long count)
+{
+    for (long i = 0; i < count; i++)
+    {
+        User user = context->users[context->cursor++ % MICRO_BENCH_POOL_SIZE];
+        save_user_to_file(&context->store.history, &context->session, user, 0);
+    }
+}
+
+static void micro_bench_load_log(micro_bench_context* context, long count)
+{
+    for (long i = 0; i < count; i++)
+    {
+        load_user_list_from_file(&context->store.history, context->users[0]);
+    }
+}
+
+static void micro_bench_export_log(micro_bench_context* context, long count)
+{
+    for (long i = 0; i < count; i++)
+    {
+        save_user_list_to_file(&context->store.history);
+    }
+}
+
+/*Timed operations, in the order of the report*/
+static const micro_benchmark s_micro_benchmarks[] = {
+    { "random_6_digits_number",      10000, micro_bench_random },
+    { "check_6_digits_number",       10000, micro_bench_check },
+    { "compare_2_string",            10000, micro_bench_compare },
+    { "update_player_table",          1000, micro_bench_update_players },
+    { "save_player_table_to_file",       1, micro_bench_save_players },
+    { "read_player_table_from_file",     1, micro_bench_read_players },
+    { "export_player_table_to_text",     1, micro_bench_export_players },
+    { "save_user_to_file",             100, micro_bench_save_game },
+    { "load_user_list_from_file",        1, micro_bench_load_log },
+    { "save_user_list_to_file",          1, micro_bench_export_log },
+};
+
+/**************************************************************************************
+ *                          MICRO BENCHMARK COMPARE
+ **************************************************************************************/
+static int micro_bench_compare_samples(const void* left, const void* right)
+{
+    double a = *(const double*)left;
+    double b = *(const double*)right;
+    return (a > b) - (a < b);
+}
+
+/**************************************************************************************
+ *                          SCRATCH DIRECTORY ENTER
+ **************************************************************************************/
+int scratch_directory_enter(char* directory, char* previousDirectory, size_t size)
+{
+    strcpy(directory, "/tmp/mock_scratch.XXXXXX");
+    if (getcwd(previousDirectory, size) == NULL || mkdtemp(directory) == NULL || chdir(directory) < 0)
+    {
+        perror("Error creating scratch directory");
+        return 0;
+    }
+    return 1;
+}
+
+/**************************************************************************************
+ *                          SCRATCH DIRECTORY LEAVE
+ **************************************************************************************/
+void scratch_directory_leave(const char* directory, const char* previousDirectory)
+{
+    static const char* const files[] = { LOG_RING_FILE, "log.txt", PENDING_INDEX_FILE, PLAYER_FILE, "top_players.txt" };
+    char path[64];
+
+    /*The next scratch directory gets its own ring file*/
+    pthread_mutex_lock(&s_file_mutex);
+    log_ring_close();
+    pthread_mutex_unlock(&s_file_mutex);
+
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++)
+    {
+        unlink(files[i]);
+        snprintf(path, sizeof(path), "%s.tmp", files[i]);
+        unlink(path);
+    }
+    if (chdir(previousDirectory) < 0 || rmdir(directory) < 0)
+    {
+        perror("Error removing scratch directory");
+    }
+}
+
+/**************************************************************************************
+ *                            RUN MICRO BENCHMARK
+ **************************************************************************************/
+int run_micro_benchmark(int argc, char* argv[])
+{
+    long sampleCount = (argc > 2) ? strtol(argv[2], NULL, 10) : MICRO_BENCH_DEFAULT_SAMPLES;
+    long warmupCount = (argc > 3) ? strtol(argv[3], NULL, 10) : sampleCount / 10;
+
+    if (sampleCount <= 0 || warmupCount < 0)
+    {
+        fprintf(stderr, "Usage: %s --bench [samples] [warmup samples]\n", argv[0]);
+        return 1;
+    }
+
+    /*The file operations run in a scratch directory, the files of the game are never touched*/
+    char directory[SCRATCH_DIRECTORY_SIZE];
+    char previousDirectory[4096];
+    if (!scratch_directory_enter(directory, previousDirectory, sizeof(previousDirectory)))
+    {
+        return 1;
+    }
+
+    micro_bench_context* context = calloc(1, sizeof(micro_bench_context));
+    double* samples = malloc((size_t)sampleCount * sizeof(double));
+    if (context == NULL || samples == NULL || !game_store_init(&context->store, 1, GAME_HISTORY_DEFAULT_CAPACITY))
+    {
+        perror("Error allocating benchmark");
+        free(context);
+        free(samples);
+        scratch_directory_leave(directory, previousDirectory);
+        return 1;
+    }
+
+    /*Fixed seed: every run times the same inputs*/
+    game_session_init(&context->session, 12345);
+    context->session.store = &context->store;
+    context->session.digitKernel->random(&context->session.magicNumber, &context->session.rng);
+    player_table_init(&context->players);
+
+    rng_state rng;
+    rng_seed(&rng, 67890);
+    for (int i = 0; i < MICRO_BENCH_POOL_SIZE; i++)
     {
-        requestComapre = '9' ;
-        switch (userRequest[0])
+        /*One input out of 8 is invalid (letter, length or "quit")*/
+        context->session.digitKernel->random(&context->inputNumbers[i], &rng);
+        packed_digits_format(&context->inputNumbers[i], DIGIT_MASK_ALL(LENGTH_NUMBER), LENGTH_NUMBER, context->inputTexts[i]);
+        switch (i % 16)
         {
-        case '1':
+        case 3:  context->inputTexts[i][2] = 'x'; break;
+        case 7:  strcat(context->inputTexts[i], "7"); break;
+        case 11: strcpy(context->inputTexts[i], "quit"); break;
+        default: break;
+        }
+
+        User* user = &context->users[i];
+        snprintf(user->userName, sizeof(user->userName), "player%d", i);
+        user->totalGuess = 1 + (int)(rng_next(&rng) % 30);
+        user->rightGuess = (int)(rng_next(&rng) % (uint64_t)user->totalGuess);
+        user->timeRecord = (float)(rng_next(&rng) % 600);
+    }
+
+    /*A full leaderboard and a full log before timing*/
+    for (int i = 0; i < MICRO_BENCH_POOL_SIZE; i++)
+    {
+        update_player_table(&context->users[i], &context->players);
+    }
+    micro_bench_save_players(context, 1);
+    micro_bench_save_game(context, (long)context->store.history.capacity);
+
+    printf("MICRO BENCHMARK\n");
+    printf("Samples         : %ld (warmup: %ld)\n", sampleCount, warmupCount);
+    printf("Players / games : %d / %zu\n", MICRO_BENCH_POOL_SIZE, context->store.history.capacity);
+    printf("%-28s %6s %10s %10s %10s %10s %10s  (ns/op)\n", "function", "batch", "min", "p50", "p90", "p99", "max");
+
+    for (size_t b = 0; b < sizeof(s_micro_benchmarks) / sizeof(s_micro_benchmarks[0]); b++)
+    {
+        const micro_benchmark* benchmark = &s_micro_benchmarks[b];
+
+        for (long i = 0; i < warmupCount; i++)
         {
-            ut_enter_request();
-            break;
+            benchmark->run(context, benchmark->batch);
         }
-        case '2':
+
+        for (long i = 0; i < sampleCount; i++)
         {
-            ut_input_user_name();
-            break; 
+            double startTime = get_time_seconds();
+            benchmark->run(context, benchmark->batch);
+            samples[i] = (get_time_seconds() - startTime) * 1e9 / (double)benchmark->batch;
         }
-        case '3':
+
+        qsort(samples, (size_t)sampleCount, sizeof(double), micro_bench_compare_samples);
+        printf("%-28s %6ld %10.1f %10.1f %10.1f %10.1f %10.1f\n", benchmark->name, benchmark->batch,
+               samples[0], samples[(sampleCount - 1) / 2], samples[(sampleCount - 1) * 90 / 100],
+               samples[(sampleCount - 1) * 99 / 100], samples[sampleCount - 1]);
+    }
+
+    /*Remove the scratch files*/
+    game_store_close(&context->store);
+    player_table_free(&context->players);
+    scratch_directory_leave(directory, previousDirectory);
+
+    free(context);
+    free(samples);
+    return 0;
+}
+
+/**************************************************************************************
+ *                          EXECUTION SERVER FUNCTION
+ **************************************************************************************/
+
+/**
+ * @brief Flag requesting the server threads to stop (set by SIGINT/SIGTERM).
+ * @details Accessed with atomic builtins: it is read by every worker thread.
+ */
+static int s_server_stop = 0;
+
+/**************************************************************************************
+ *                            SERVER SIGNAL HANDLER
+ **************************************************************************************/
+static void server_signal_handler(int signalNumber)
+{
+    int savedErrno = errno;
+
+    (void)signalNumber;
+    __atomic_store_n(&s_server_stop, 1, __ATOMIC_RELAXED);
+    errno = savedErrno;
+}
+
+/**************************************************************************************
+ *                            SERVER OPEN LISTENER
+ **************************************************************************************/
+int server_open_listener(const char* address)
+{
+    int listenFd = -1;
+
+    if (strncmp(address, "unix:", 5) == 0)
+    {
+        struct sockaddr_un unixAddress;
+        const char* path = address + 5;
+
+        if (strlen(path) == 0 || strlen(path) >= sizeof(unixAddress.sun_path))
         {
-            ut_random_6_digits_number();
-            break;
+            fprintf(stderr, "Invalid socket path: %s\n", path);
+            return -1;
         }
-        case '4': 
+
+        memset(&unixAddress, 0, sizeof(unixAddress));
+        unixAddress.sun_family = AF_UNIX;
+        strcpy(unixAddress.sun_path, path);
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0)
         {
-            ut_input_6_digits_number();
-            break;
+            perror("Error creating socket");
+            return -1;
         }
-        case '5': 
+
+        /*Remove the socket file of a previous run*/
+        unlink(path);
+
+        if (bind(listenFd, (struct sockaddr*)&unixAddress, sizeof(unixAddress)) < 0)
         {
-            ut_compare_2_string();
-            break;
+            perror("Error binding socket");
+            close(listenFd);
+            return -1;
         }
-        case '6': 
+    }
+    else if (strncmp(address, "tcp:", 4) == 0)
+    {
+        struct sockaddr_in tcpAddress;
+        long port = strtol(address + 4, NULL, 10);
+        int reuse = 1;
+
+        if (port <= 0 || port > 65535)
         {
-            ut_load_read_save_print_top_file();
-            break; 
+            fprintf(stderr, "Invalid port: %s\n", address + 4);
+            return -1;
         }
-        case '7':
+
+        memset(&tcpAddress, 0, sizeof(tcpAddress));
+        tcpAddress.sin_family = AF_INET;
+        tcpAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+        tcpAddress.sin_port = htons((unsigned short)port);
+
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0)
         {
-            ut_save_and_load_file(); 
-            break; 
+            perror("Error creating socket");
+            return -1;
         }
-        case '8':
+
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        if (bind(listenFd, (struct sockaddr*)&tcpAddress, sizeof(tcpAddress)) < 0)
         {
-            memset(user.userName,'\0',sizeof(user.userName));
-            break; 
+            perror("Error binding socket");
+            close(listenFd);
+            return -1;
         }
-        case '9':
-            break;
-        }  
-        break; 
     }
-    default: 
+    else
+    {
+        fprintf(stderr, "Invalid address (unix:<path> or tcp:<port>): %s\n", address);
+        return -1;
+    }
+
+    if (listen(listenFd, SOMAXCONN) < 0)
     {
-        requestComapre = '3';
-        switch (userRequest[0])
-        {
-        /*Create account*/
-        case '1':
+        perror("Error listening socket");
+        close(listenFd);
+        return -1;
+    }
+
+    return listenFd;
+}
+
+/**************************************************************************************
+ *                          SERVER CONNECTION OUTPUT
+ **************************************************************************************/
+void server_connection_output(void* context, const char* text, size_t length)
+{
+    server_connection* connection = (server_connection*)context;
+
+    /*Grow the output buffer*/
+    if (connection->outCapacity - connection->outLength < length)
+    {
+        size_t newCapacity = (connection->outCapacity == 0) ? 256 : connection->outCapacity;
+        while (newCapacity - connection->outLength < length)
         {
-            /*Input user name*/
-            do
-            {
-                isValid = input_user_name(&user);
-            } while (isValid == 0);
+            newCapacity *= 2;
+        }
 
-            break; 
+        char* newBuffer = realloc(connection->outBuffer, newCapacity);
+        if (newBuffer == NULL)
+        {
+            connection->isClosing = 1;
+            return;
         }
+        connection->outBuffer = newBuffer;
+        connection->outCapacity = newCapacity;
+    }
 
-        /*Start game*/
-        case '2': 
+    memcpy(connection->outBuffer + connection->outLength, text, length);
+    connection->outLength += length;
+}
+
+/**************************************************************************************
+ *                          SERVER CONNECTION FLUSH
+ **************************************************************************************/
+int server_connection_flush(server_connection* connection)
+{
+    while (connection->outSent < connection->outLength)
+    {
+        ssize_t sent = send(connection->fd, connection->outBuffer + connection->outSent,
+                            connection->outLength - connection->outSent, MSG_NOSIGNAL);
+        if (sent < 0)
         {
-            /*Check user has account yet*/
-            if(strlen(user.userName) == 0)
+            if (errno == EINTR)
             {
-                /*clear isValid*/
-                isValid = 0; 
-                printf("You dont't have account.Cannot start the game\n"); 
-                break; 
+                continue;
             }
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        connection->outSent += (size_t)sent;
+    }
+
+    /*All output written, reuse the buffer from the start*/
+    connection->outLength = 0;
+    connection->outSent = 0;
+    return 1;
+}
+
+/**************************************************************************************
+ *                          SERVER HANDLE INPUT
+ **************************************************************************************/
+void server_handle_input(game_server* server, server_connection* connection)
+{
+    (void)server;
 
-            /*Load log.txt and compare user_name*/ 
-            userPostionString = load_user_list_from_file(users,user);
+    ssize_t received = line_reader_fill(&connection->input);
 
-            /*Clear for new user*/
-            user.totalGuess = 0;
-            user.rightGuess = 0;
-            user.timeRecord = 0.0f; 
+    if (received == 0)
+    {
+        /*Client closed the connection*/
+        connection->isClosing = 1;
+        return;
+    }
 
-            /*Check account had not been finished game before yet*/
-            if(userPostionString != -1)
-            {
-                printf("Your account had not finnished the last game yet.\n");
-            }
+    if (received < 0)
+    {
+        if (connection->input.isEof)
+        {
+            connection->isClosing = 1;
+        }
+        return;
+    }
 
-            printf(GREEN"\n                                                    GAME START\n"RESET);
+    server_process_input(connection);
+}
 
-            /*Create magic number*/
-            random_6_digits_number();
+/**************************************************************************************
+ *                          SERVER PROCESS INPUT
+ **************************************************************************************/
+void server_process_input(server_connection* connection)
+{
+    char* line;
+    int status;
+    while (!connection->isClosing && game_session_commit_poll(&connection->session) &&
+           (status = line_reader_next(&connection->input, &line)) >= 0)
+    {
+        game_step(&connection->session, (status == 1) ? line : NULL);
 
-            /*clear common_char string*/
-            memset(g_common_char,'\0',sizeof(g_common_char));
-            memset(g_common_char,'_',LENGTH_NUMBER);  
+        /*Exit request*/
+        if (connection->session.state == GAME_STATE_STOPPED)
+        {
+            session_printf(&connection->session, "Bye\n");
+            connection->isClosing = 1;
+        }
+    }
+}
 
-            /*Update data of last play*/
-            if(userPostionString != -1)
-            {
-                user = users[userPostionString]; 
-                user.totalGuess -= 1; 
-                strcpy(g_magic_number,g_magic_number_old[userPostionString]); 
-                strcpy(g_common_char,g_common_char_old[userPostionString]); 
-                isAllCorrect = 0; 
-            }
+/**************************************************************************************
+ *                          SERVER CONNECTION UPDATE
+ **************************************************************************************/
+int server_connection_update(server_worker* worker, server_connection* connection, int isHangup)
+{
+    /*The output of a client waiting for its record is held until the record is saved*/
+    int isWaiting = (connection->session.commitTicket != 0);
+    int flushStatus = isWaiting ? 0 : server_connection_flush(connection);
+
+    if (isHangup || flushStatus < 0 || (connection->isClosing && flushStatus == 1))
+    {
+        server_connection_close(worker, connection);
+        return 0;
+    }
+
+    /*Stop reading while output is pending, so a slow client cannot grow the buffer*/
+    unsigned int wantedEvents = isWaiting ? 0 : (flushStatus == 0) ? EPOLLOUT : EPOLLIN;
+    if (wantedEvents != connection->epollEvents)
+    {
+        struct epoll_event event;
+        event.events = wantedEvents;
+        event.data.ptr = connection;
+        epoll_ctl(worker->epollFd, EPOLL_CTL_MOD, connection->fd, &event);
+        connection->epollEvents = wantedEvents;
+    }
+
+    return 1;
+}
+
+/**************************************************************************************
+ *                            SERVER COMMIT NOTIFY
+ **************************************************************************************/
+void server_commit_notify(void* context)
+{
+    game_server* server = (game_server*)context;
+    uint64_t one = 1;
+
+    for (int i = 0; i < server->threadCount; i++)
+    {
+        if (write(server->commitEventFds[i], &one, sizeof(one)) < 0 && errno != EAGAIN)
+        {
+            perror("Error waking server thread");
+        }
+    }
+}
+
+/**************************************************************************************
+ *                           SERVER RESUME COMMITS
+ **************************************************************************************/
+void server_resume_commits(server_worker* worker)
+{
+    uint64_t wakeCount;
+
+    if (read(worker->commitEventFd, &wakeCount, sizeof(wakeCount)) < 0 && errno != EAGAIN)
+    {
+        perror("Error reading eventfd");
+    }
+
+    server_connection* connection = worker->connections;
+    while (connection != NULL)
+    {
+        server_connection* next = connection->next;
+
+        if (connection->session.commitTicket != 0 && game_session_commit_poll(&connection->session))
+        {
+            server_process_input(connection);
+            server_connection_update(worker, connection, 0);
+        }
+        connection = next;
+    }
+}
+
+/**************************************************************************************
+ *                          SERVER CONNECTION CLOSE
+ **************************************************************************************/
+void server_connection_close(server_worker* worker, server_connection* connection)
+{
+    /*Save the game left in progress like a "quit"*/
+    game_session_abandon(&connection->session);
+
+    if (connection->previous != NULL)
+    {
+        connection->previous->next = connection->next;
+    }
+    else
+    {
+        worker->connections = connection->next;
+    }
+    if (connection->next != NULL)
+    {
+        connection->next->previous = connection->previous;
+    }
 
-            /*Print for fast checking*/ 
-            printf("%s\n", g_magic_number);
+    /*Closing the fd also removes it from the epoll instance*/
+    close(connection->fd);
+    free(connection->outBuffer);
+    free(connection);
+}
 
-            /*Capture start time*/
-            startTime = time(NULL);   
+/**************************************************************************************
+ *                        SERVER ACCEPT CONNECTIONS
+ **************************************************************************************/
+void server_accept_connections(server_worker* worker)
+{
+    game_server* server = worker->server;
+    int epollFd = worker->epollFd;
 
-            /*Guess magic number*/
-            do
+    for (;;)
+    {
+        int clientFd = accept4(server->listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientFd < 0)
+        {
+            if (errno == EINTR)
             {
-                /*Increase guess count*/
-                user.totalGuess++;
+                continue;
+            }
+            /*EAGAIN: no more pending client (other errors: retry on next event)*/
+            return;
+        }
 
-                /*Guess time*/
-                printf("%d.", user.totalGuess);
+        server_connection* connection = calloc(1, sizeof(server_connection));
+        if (connection == NULL)
+        {
+            close(clientFd);
+            continue;
+        }
 
-                /*Clear isValid*/
-                isValid = 0; 
+        connection->fd = clientFd;
+        line_reader_init(&connection->input, clientFd, GAME_LINE_MAX);
+        game_session_init(&connection->session, __atomic_fetch_add(&server->sessionSeed, 1, __ATOMIC_RELAXED));
+        connection->session.store = &server->store;
+        connection->session.output = server_connection_output;
+        connection->session.outputContext = connection;
+        connection->session.isPlain = 1;
+        connection->session.digitCount = server->digitCount;
+        connection->session.isCommitDeferred = 1;
+
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = connection;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, clientFd, &event) < 0)
+        {
+            close(clientFd);
+            free(connection);
+            continue;
+        }
 
-                /*Enter the input string number*/
-                do
-                {
-                    /*Clear StopGame*/
-                    stopGame = 0;
-
-                    /*Enter input*/
-                    isValid = input_6_digits_number();
-
-                    if (isValid == -1) // If user entered "quit"
-                    {
-                        /*Capture end guessing action */
-                        endTime = time(NULL);   
-                        user.timeRecord = difftime(endTime,startTime); 
-
-                        /*Save to log file*/
-                        save_user_to_file(users,user,isAllCorrect);  
-                        stopGame = 1; 
-                        initCheck = 1; 
-                        break; 
-                    }
-                } while (isValid == 0); 
-
-                /*Stop game*/
-                if (stopGame)
-                    break;
+        connection->epollEvents = EPOLLIN;
 
-                /*Compare*/
-                isAllCorrect = compare_2_string(&user);
+        connection->next = worker->connections;
+        if (worker->connections != NULL)
+        {
+            worker->connections->previous = connection;
+        }
+        worker->connections = connection;
 
-            } while (isAllCorrect == 0);
+        game_session_start(&connection->session);
+        if (server_connection_flush(connection) == 0)
+        {
+            event.events = EPOLLOUT;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, clientFd, &event);
+            connection->epollEvents = EPOLLOUT;
+        }
+    }
+}
 
-            /*Stop game*/
-            if (stopGame)
-                break;
+/**************************************************************************************
+ *                            RUN SERVER WORKER
+ **************************************************************************************/
+void* run_server_worker(void* arg)
+{
+    server_worker* worker = (server_worker*)arg;
+    game_server* server = worker->server;
+    struct epoll_event events[SERVER_MAX_EVENTS];
+
+    while (!__atomic_load_n(&s_server_stop, __ATOMIC_RELAXED))
+    {
+        int eventCount = epoll_wait(worker->epollFd, events, SERVER_MAX_EVENTS, 500);
+        int isCommitWoken = 0;
+
+        for (int i = 0; i < eventCount; i++)
+        {
+            /*The listening socket is registered with a NULL pointer, the eventfd with the worker*/
+            if (events[i].data.ptr == NULL)
+            {
+                server_accept_connections(worker);
+                continue;
+            }
+            if (events[i].data.ptr == worker)
+            {
+                isCommitWoken = 1;
+                continue;
+            }
 
-            /*Capture end guessing action */
-            endTime = time(NULL);   
+            server_connection* connection = events[i].data.ptr;
+            int isHangup = ((events[i].events & (EPOLLERR | EPOLLHUP)) != 0);
 
-            user.timeRecord += difftime(endTime,startTime); 
+            if (isHangup)
+            {
+                connection->isClosing = 1;
+            }
+            else if (events[i].events & EPOLLIN)
+            {
+                server_handle_input(server, connection);
+            }
 
-            /*read player table*/
-            if (initCheck)
-                read_player_table_from_file(&top_players);
+            server_connection_update(worker, connection, isHangup);
+        }
 
-            /* Update the player table */
-            update_player_table(&user,&top_players);
+        /*Resuming may close clients: only once no event of the batch points to them any more*/
+        if (isCommitWoken)
+        {
+            server_resume_commits(worker);
+        }
+    }
 
-            /*Save to file*/
-            save_player_table_to_file(&top_players);
+    /*Save the games of the clients still connected, the store is closed after the threads stop*/
+    while (worker->connections != NULL)
+    {
+        server_connection_close(worker, worker->connections);
+    }
 
-            /*Save to log file*/
-            save_user_to_file(users, user, isAllCorrect);
+    return NULL;
+}
 
-                printf("\n                                 /\\_/\\  (   \n");
-                printf("                                ( ^.^ ) _)  \n");    
-                printf("                                  \"/  (    \n");    
-                printf("                                ( | | )     \n");    
-                printf("                               (__d b__)    ");    
+/**************************************************************************************
+ *                                RUN SERVER
+ **************************************************************************************/
+int run_server(int argc, char* argv[])
+{
+    double startTime = get_time_seconds();
+    const char* address = (argc > 2) ? argv[2] : NULL;
+    long threadCount = 1;
+    long historyCapacity = GAME_HISTORY_DEFAULT_CAPACITY;
+    int digitCount = LENGTH_NUMBER;
+    uint64_t seed = (uint64_t)time(NULL);
+    int isSeedValid = 1;
+    int isPersistValid = 1;
+
+    /*Parse options*/
+    for (int i = 3; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            threadCount = strtol(argv[++i], NULL, 10);
+        }
+        else if (parse_persist_option(argc, argv, &i, &isPersistValid))
+        {
+            continue;
+        }
+        else if (strcmp(argv[i], "--history") == 0 && i + 1 < argc)
+        {
+            historyCapacity = strtol(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--digits") == 0 && i + 1 < argc)
+        {
+            digitCount = parse_digit_count(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            isSeedValid = parse_seed(argv[++i], &seed);
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
 
+    if (address == NULL || threadCount <= 0 || threadCount > SERVER_MAX_THREADS ||
+        historyCapacity <= 0 || historyCapacity > GAME_HISTORY_MAX_CAPACITY || digitCount == 0 || !isSeedValid || !isPersistValid)
+    {
+        fprintf(stderr, "Usage: %s --server <unix:path|tcp:port> [--threads 1..%d] [--history 1..%ld] [--digits %s] [--seed n]\n"
+                        "       " PERSIST_USAGE "\n",
+                argv[0], SERVER_MAX_THREADS, GAME_HISTORY_MAX_CAPACITY, DIGIT_COUNT_CHOICES);
+        return 1;
+    }
 
-            printf("CONGRATULATION!\n");
-            printf("                         Do you want to see the 10 highest table(y/Y. YES n/N. No): "); 
+    static game_server server;
+    static server_worker workers[SERVER_MAX_THREADS];
 
-            char printRequest[3];
-            isValid = 0; 
+    memset(&server, 0, sizeof(server));
+    server.threadCount = (int)threadCount;
+    server.sessionSeed = seed;
+    server.digitCount = digitCount;
 
-            do {
-                /*CLear print_request*/
-                memset(printRequest, '\0',3);
+    /*Load the saved games and player table once*/
+    if (!game_store_init(&server.store, 1, (size_t)historyCapacity))
+    {
+        return 1;
+    }
 
-                /* Read user input*/
-                fgets(printRequest, sizeof(printRequest), stdin);
+    server.listenFd = server_open_listener(address);
+    if (server.listenFd < 0)
+    {
+        return 1;
+    }
 
-                /* Check for valid input (y/Y or n/N)*/
-                if (printRequest[0] == 'y' || printRequest[0] == 'Y') 
-                {
+    /*Stop on SIGINT/SIGTERM, a closed client must not kill the process*/
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = server_signal_handler;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
 
-                    print_high_score(&top_players);
-                    isValid = 1; // Valid input, exit the loop
-                } 
-                else if (printRequest[0] == 'n' || printRequest[0] == 'N') 
-                {
-                    isValid = 1; // Valid input, exit the loop
-                } else 
-                {
-                    printf(RED"                         Invalid input. Please enter y/Y for YES or n/N for NO: "RESET);
-                }
+    /*Every thread has its own epoll instance, all of them wait on the listening socket*/
+    for (long i = 0; i < threadCount; i++)
+    {
+        struct epoll_event event;
 
-                if(strlen(printRequest) > 2)
-                {
-                    /* Clear cache */
-                    while (getchar() != '\n');
-                }
-            } while (!isValid);
+        workers[i].server = &server;
+        workers[i].epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (workers[i].epollFd < 0)
+        {
+            perror("Error creating epoll");
+            return 1;
+        }
 
-            /*Clear all variables of struct for new player*/
-            user.totalGuess = 0;
-            user.rightGuess = 0;
-            user.timeRecord = 0.0f; 
-            memset(user.userName,'\0',sizeof(user.userName));  
+        event.events = EPOLLIN | EPOLLEXCLUSIVE;
+        event.data.ptr = NULL;
+        if (epoll_ctl(workers[i].epollFd, EPOLL_CTL_ADD, server.listenFd, &event) < 0)
+        {
+            perror("Error registering listening socket");
+            return 1;
+        }
 
-            initCheck = 1; 
-            break;
+        /*Commit mode: the writer wakes the thread when the records of its clients are saved*/
+        workers[i].commitEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        server.commitEventFds[i] = workers[i].commitEventFd;
+        event.events = EPOLLIN;
+        event.data.ptr = &workers[i];
+        if (workers[i].commitEventFd < 0 || epoll_ctl(workers[i].epollFd, EPOLL_CTL_ADD, workers[i].commitEventFd, &event) < 0)
+        {
+            perror("Error registering eventfd");
+            return 1;
         }
+    }
+
+    if (server.store.writer != NULL && server.store.writer->options.mode == PERSIST_SYNC_COMMIT)
+    {
+        persist_writer_set_notify(server.store.writer, server_commit_notify, &server);
+    }
+
+    printf("Server listening on %s with %ld thread(s), started in %.3f ms (%zu games, %d players loaded)\n", address, threadCount,
+           (get_time_seconds() - startTime) * 1e3, server.store.history.count, server.store.topPlayers.nodeCount);
+    fflush(stdout);
+
+    for (long i = 1; i < threadCount; i++)
+    {
+        pthread_create(&workers[i].thread, NULL, run_server_worker, &workers[i]);
+    }
+    run_server_worker(&workers[0]);
+
+    for (long i = 1; i < threadCount; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    for (long i = 0; i < threadCount; i++)
+    {
+        close(workers[i].epollFd);
+    }
+    close(server.listenFd);
 
-        /*Exit*/
-        case '3':
-        {
-            break;; 
-        }
-        default:
-            break;
-        }
-        break; 
+    if (strncmp(address, "unix:", 5) == 0)
+    {
+        unlink(address + 5);
     }
+
+    /*The writer wakes the threads until it stops*/
+    game_store_close(&server.store);
+    for (long i = 0; i < threadCount; i++)
+    {
+        close(workers[i].commitEventFd);
     }
-    }while(userRequest[0] != requestComapre); 
 
-    return 0; 
+    persist_stats stats;
+    persist_stats_read(&stats);
+    printf("Server stopped\n");
+    persist_stats_print(&stats);
+    return 0;
 }
 
 /**************************************************************************************
- *                             EXECUTION FUNCTION
+ *                        EXECUTION LOAD GENERATOR FUNCTION
  **************************************************************************************/
 
+/*Names of the bot kinds and of the phases, in the order of their enums*/
+static const char* const s_bot_kind_names[BOT_KIND_COUNT] = { "random", "solver", "quitter" };
+static const char* const s_loadgen_phase_names[LOADGEN_PHASE_COUNT] = {
+    "connect", "account", "start", "resume", "guess", "win", "quit", "score"
+};
+
 /**************************************************************************************
- *                              PRINT_INTERFACE
+ *                            LATENCY SAMPLES PUSH
  **************************************************************************************/
-void printf_interface(User user)
+static void latency_samples_push(latency_samples* samples, double value)
 {
-    printf(BLUE"                                  ___  __  __  ____  ___     ___    __    __  __  ____ \n" RESET);
-    printf(GREEN"                                 / __)(  )(  )( ___)/ __)   / __)  /__\\  (  \\/  )( ___)\n" RESET);
-    printf(YELLOW"                                ( (_-. )(__)(  )__) \\__\\   ( (_-. /(__)\\  )    (  )__) \n" RESET);
-    printf(RED"                                 \\___/(______)(____)(___/   \\___/(__)(__)(_/\\/\\_)(____)\n\n" RESET);
-
-    printf("                                        Welcome to Gues Game by tranquangnguyenanh.\n\n");
-
-    if(g_check_admin)
-    {
-        printf("\n                                            UNIT TEST FOR ADMIN\n");
-        printf("                                        1. UT_ENTER_REQUEST\n");
-        printf("                                        2. UT_INPUT_USER_NAME\n");
-        printf("                                        3. UT_RANDOM_6_DIGITS_NUMBER\n"); 
-        printf("                                        4. UT_INPUT_6_DIGITS_NUMBER\n");
-        printf("                                        5. UT_COMPARE_2_STRING\n");
-        printf("                                        6. UT_INTERRACT_WITH_TOP_PLAYER_FILE\n");
-        printf("                                        7. UT_INTERRACT_WITH_LOG_FILE\n");
-        printf("                                        8. EXIT\n");
-        printf("                                        9. STOP PROGRAM\n"); 
-    }
-    else
+    if (samples->count == samples->capacity)
     {
-        printf("                                                        MENU\n");
-        printf("                                                1. CREATE ACCOUNT\n");
-        printf("                                                2.      PLAY\n");
-        printf("                                                3.      EXIT\n"); 
+        size_t capacity = (samples->capacity == 0) ? 1024 : samples->capacity * 2;
+        double* values = realloc(samples->values, capacity * sizeof(double));
+        if (values == NULL)
+        {
+            return;
+        }
+        samples->values = values;
+        samples->capacity = capacity;
     }
+    samples->values[samples->count++] = value;
 }
 
 /**************************************************************************************
- *                              ENTER_REQUEST
+ *                              LOADGEN BOT OUTPUT
  **************************************************************************************/
-void enter_request(char userRequest[3])
+static void loadgen_bot_output(void* context, const char* text, size_t length)
 {
-    int isValid  = 0; 
-    do
-    {
-        /* Clear request */
-        memset(userRequest,'\0', 3);
+    loadgen_bot* bot = (loadgen_bot*)context;
+    size_t space = sizeof(bot->response) - 1 - bot->responseLength;
 
-        /* Enter request */
-        printf("Enter your request: ");
-        if (fgets(userRequest, 3, stdin) != NULL)
+    /*A very long answer keeps its end, where the result and the prompt are*/
+    if (length > space)
+    {
+        size_t keep = sizeof(bot->response) / 4;
+        if (length >= keep)
+        {
+            text += length - keep;
+            length = keep;
+            bot->responseLength = 0;
+        }
+        else
         {
-            /* Calculate the length of request string */
-            size_t dataLength = strlen(userRequest);
+            memmove(bot->response, bot->response + bot->responseLength - (keep - length), keep - length);
+            bot->responseLength = keep - length;
+        }
+    }
 
-            /* Remove the newline character if present */
-            if (dataLength > 0 && userRequest[dataLength - 1] == '\n')
-            {
-                userRequest[dataLength - 1] = '\0';
-                dataLength--;
-            }
+    memcpy(bot->response + bot->responseLength, text, length);
+    bot->responseLength += length;
+    bot->response[bot->responseLength] = '\0';
+}
 
-            switch(g_check_admin)
-            {
-            case 1:
-            {
-                /* Validate input */
-                if (dataLength == 1 && userRequest[0] >= '1' &&  userRequest[0] <= '9')
-                {
-                    isValid = 1;
-                }
-                else
-                {
-                    printf(RED"Invalid request\n"RESET);
+/**************************************************************************************
+ *                              LOADGEN BOT GUESS
+ **************************************************************************************/
+static void loadgen_bot_guess(loadgen_bot* bot, int digitCount)
+{
+    bot->guessCount++;
 
-                    /*Clear cache*/
-                    if(dataLength > 1 )
-                        while (getchar() != '\n');
-                }
-                break; 
-            }
-            default: 
-            {
-                /* Validate input */
-                if (dataLength == 1 && userRequest[0] >= '1' &&  userRequest[0] <= '3')
-                {
-                    isValid = 1;
-                }
-                else
-                {
-                    printf(RED"Invalid request\n"RESET);
+    if (bot->kind == BOT_KIND_RANDOM)
+    {
+        guesser_random(bot->knownText, bot->guessCount, bot->line, &bot->seed);
+        return;
+    }
 
-                    /*Clear cache*/
-                    if(dataLength > 1 )
-                        while (getchar() != '\n');
-                }
-                break; 
-            }
-            }
-            
-        }
-        else
+    /*Solver: the lowest digit not ruled out yet on every unknown position*/
+    for (int i = 0; i < digitCount; i++)
+    {
+        int digit = 0;
+        while (digit < 9 && (bot->triedDigits[i] & (1u << digit)))
         {
+            digit++;
         }
-    } while (isValid == 0);
+        bot->line[i] = (bot->knownText[i] != '_') ? bot->knownText[i] : (char)('0' + digit);
+    }
+    bot->line[digitCount] = '\0';
 }
 
 /**************************************************************************************
- *                              INPUT_USER_NAME
+ *                              LOADGEN BOT ANSWER
  **************************************************************************************/
-int input_user_name(User* user)
+static const char* loadgen_bot_answer(loadgen_worker* worker, loadgen_bot* bot)
 {
-    /*Check String is valid or invalid*/
-    /*1: valid  ; 0: invalid*/
-    int isValid = 1;
+    const char* response = bot->response;
+    int digitCount = worker->digitCount;
+    loadgen_phase phase = LOADGEN_PHASE_COUNT;
 
-    /*Print request*/
-    printf("User name: ");
-
-    /*Clear string before type*/
-    memset(user->userName, '\0', sizeof(user->userName));
+    switch (bot->step)
+    {
+    case BOT_STEP_CONNECT:
+        phase = LOADGEN_PHASE_CONNECT;
+        strcpy(bot->line, "1");
+        bot->step = BOT_STEP_CREATE;
+        break;
+
+    case BOT_STEP_CREATE:
+        phase = LOADGEN_PHASE_ACCOUNT;
+        strcpy(bot->line, bot->userName);
+        bot->step = BOT_STEP_NAME;
+        break;
+
+    case BOT_STEP_NAME:
+        phase = LOADGEN_PHASE_ACCOUNT;
+        strcpy(bot->line, "2");
+        bot->step = BOT_STEP_START;
+        break;
+
+    case BOT_STEP_START:
+        phase = (strstr(response, "not finnished") != NULL) ? LOADGEN_PHASE_RESUME : LOADGEN_PHASE_START;
+
+        /*A new game: nothing is known, a resumed game keeps what the bot has seen*/
+        if (phase == LOADGEN_PHASE_START || bot->knownText[0] == '\0')
+        {
+            memset(bot->knownText, '_', (size_t)digitCount);
+            bot->knownText[digitCount] = '\0';
+            memset(bot->triedDigits, 0, sizeof(bot->triedDigits));
+            bot->guessCount = 0;
+            bot->hasQuit = 0;
+        }
+        loadgen_bot_guess(bot, digitCount);
+        bot->step = BOT_STEP_GUESS;
+        break;
 
-    /*Input string*/
-    if (fgets(user->userName, sizeof(user->userName), stdin) != NULL)
+    case BOT_STEP_GUESS:
     {
-        /*Calculate the length of user_name string*/
-        size_t dataLength = strlen(user->userName);
+        worker->guesses++;
 
-        /*Delete the downline char*/
-        if (dataLength > 0 && user->userName[dataLength-1] == '\n')
+        if (strstr(response, "CONGRATULATION") != NULL)
         {
-            user->userName[dataLength-1] = '\0'; 
-            dataLength--; 
+            phase = LOADGEN_PHASE_WIN;
+            worker->games++;
+            bot->knownText[0] = '\0';
+            strcpy(bot->line, "n");
+            bot->step = BOT_STEP_SCORE;
+            break;
         }
 
-        /*Check length of user name*/
-        if (dataLength > LENGTH_STRING_MAX)
+        /*The guess must be scored, anything else is a digit count mismatch*/
+        const char* result = strstr(response, "Result: ");
+        if (result == NULL)
         {
-            isValid = 0;
-            printf(RED,"The length exceeds the allowed maximum of %d characters.\n", LENGTH_STRING_MAX,RESET);
-
-            /*Clear cache */
-            while (getchar() != '\n'); 
+            worker->failedBots++;
+            bot->step = BOT_STEP_DONE;
+            return NULL;
         }
-        else
+
+        phase = LOADGEN_PHASE_GUESS;
+        result += strlen("Result: ");
+        for (int i = 0; i < digitCount && result[i] != '\0'; i++)
         {
-            /*Check the string user_name is valid*/
-            for (int i = 0; user->userName[i] != '\0'; i++)
+            if (result[i] == '_')
             {
-                if (!isalnum(user->userName[i]))
-                {
-                    isValid = 0; 
-                    break; 
-                }
+                bot->triedDigits[i] |= (uint16_t)(1u << (bot->line[i] - '0'));
+            }
+            else
+            {
+                bot->knownText[i] = result[i];
             }
         }
 
-        /*Double check*/
-        if (isValid)
+        if (bot->kind == BOT_KIND_QUITTER && !bot->hasQuit && bot->guessCount >= LOADGEN_QUIT_GUESSES)
         {
-           /*Finish the task*/
+            bot->hasQuit = 1;
+            strcpy(bot->line, "quit");
+            bot->step = BOT_STEP_QUIT;
         }
         else
         {
-            printf(RED"User name is not valid\nPlease enter the user name again\n"RESET); 
+            loadgen_bot_guess(bot, digitCount);
         }
+        break;
     }
-    else 
-    {}
 
-    return isValid; 
+    case BOT_STEP_QUIT:
+        phase = LOADGEN_PHASE_QUIT;
+        strcpy(bot->line, "2");
+        bot->step = BOT_STEP_START;
+        break;
+
+    case BOT_STEP_SCORE:
+        /*The session clears the user after the 10 highest table prompt: log in again for the next game*/
+        phase = LOADGEN_PHASE_SCORE;
+        bot->gamesLeft--;
+        strcpy(bot->line, (bot->gamesLeft > 0) ? "1" : "3");
+        bot->step = (bot->gamesLeft > 0) ? BOT_STEP_CREATE : BOT_STEP_EXIT;
+        break;
+
+    case BOT_STEP_EXIT:
+    case BOT_STEP_DONE:
+    default:
+        bot->step = BOT_STEP_DONE;
+        return NULL;
+    }
+
+    latency_samples_push(&worker->samples[phase], bot->answerTime - bot->sentTime);
+    worker->requests++;
+
+    bot->responseLength = 0;
+    bot->response[0] = '\0';
+    return bot->line;
 }
 
 /**************************************************************************************
- *                            RANDOM_6_DIGIT_NUMBER
+ *                             LOADGEN RUN ENGINE
  **************************************************************************************/
-void random_6_digits_number(void)
+static void loadgen_run_engine(loadgen_worker* worker)
 {
-    /*Clear string*/
-    memset(g_magic_number, '\0', sizeof(g_magic_number));
-
-    /*Restart the time CPU*/
-    srand(time(NULL));
+    long activeCount = worker->botCount;
 
-    /*Create magic number*/
-    for (int i = 0; i < LENGTH_NUMBER; i++)
+    /*Every bot has its own session on the shared store*/
+    for (long i = 0; i < worker->botCount; i++)
     {
-        g_magic_number[i] = '0' + (rand() % 10); 
+        loadgen_bot* bot = &worker->bots[i];
+
+        bot->session.store = worker->store;
+        bot->session.output = loadgen_bot_output;
+        bot->session.outputContext = bot;
+        bot->session.isPlain = 1;
+        bot->session.digitCount = worker->digitCount;
+
+        bot->sentTime = get_time_seconds();
+        game_session_start(&bot->session);
+        bot->answerTime = get_time_seconds();
     }
 
-    /*Null set at the EOS (end of string)*/
-    g_magic_number[LENGTH_NUMBER] = '\0'; 
+    /*Step the sessions in turn, one request per bot*/
+    while (activeCount > 0)
+    {
+        for (long i = 0; i < worker->botCount; i++)
+        {
+            loadgen_bot* bot = &worker->bots[i];
+            if (bot->step == BOT_STEP_DONE)
+            {
+                continue;
+            }
+
+            const char* line = loadgen_bot_answer(worker, bot);
+            if (line == NULL)
+            {
+                activeCount--;
+                continue;
+            }
+
+            bot->sentTime = get_time_seconds();
+            game_step(&bot->session, line);
+            bot->answerTime = get_time_seconds();
+        }
+    }
 }
 
 /**************************************************************************************
- *                            INPUT_6_DIGIT_NUMBER
+ *                               LOADGEN CONNECT
  **************************************************************************************/
-int input_6_digits_number(void)
+static int loadgen_connect(const char* address)
 {
-    /*Check String is valid or invalid*/
-    /*1: valid  ; 0: invalid*/
-    int isValid = 1;
+    int fd = -1;
 
-    /*Clear string*/
-    memset(g_input_number, '\0', sizeof(g_input_number));
+    if (strncmp(address, "unix:", 5) == 0)
+    {
+        struct sockaddr_un unixAddress;
 
-    /*Print request*/
-    printf("Enter the number(quit for stop game): "); 
+        memset(&unixAddress, 0, sizeof(unixAddress));
+        unixAddress.sun_family = AF_UNIX;
+        snprintf(unixAddress.sun_path, sizeof(unixAddress.sun_path), "%s", address + 5);
 
-    /*Enter 6 digit number*/
-    if (fgets(g_input_number, sizeof(g_input_number), stdin) != NULL)
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, (struct sockaddr*)&unixAddress, sizeof(unixAddress)) < 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    else if (strncmp(address, "tcp:", 4) == 0)
     {
-        /*Calculate the length of input_number string*/
-        size_t dataLength = strlen(g_input_number);
-
-        /*Delete the downline char*/
-        if (dataLength > 0 && g_input_number[dataLength-1] == '\n')
+        /*"tcp:port" (local host) or "tcp:host:port"*/
+        char host[256] = "127.0.0.1";
+        const char* port = strrchr(address + 4, ':');
+        if (port == NULL)
         {
-            g_input_number[dataLength-1] = '\0'; 
-            dataLength--; 
-        } 
-
-        /* Check if the user wants to quit */
-        if (strcmp(g_input_number, "quit") == 0)
+            port = address + 4;
+        }
+        else
         {
-            return -1; // Special return value to indicate "quit"
+            snprintf(host, sizeof(host), "%.*s", (int)(port - (address + 4)), address + 4);
+            port++;
         }
 
-        /*Check length of string*/
-        if (dataLength != LENGTH_NUMBER)
+        struct addrinfo hints;
+        struct addrinfo* addresses = NULL;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        if (getaddrinfo(host, port, &hints, &addresses) != 0)
         {
-            printf(RED"Input number invalid\n"RESET);
-            
-
-            /*clear cache*/
-            if(dataLength > LENGTH_NUMBER)
-                while (getchar() != '\n');
-
-            /*invalid input*/
-            isValid = 0; 
-            return isValid; 
+            return -1;
         }
-        else
+
+        for (struct addrinfo* entry = addresses; entry != NULL && fd < 0; entry = entry->ai_next)
         {
-            /*Check input_number elements are numeric*/
-            for (int i = 0; i < LENGTH_NUMBER; i++)
+            fd = socket(entry->ai_family, entry->ai_socktype | SOCK_CLOEXEC, entry->ai_protocol);
+            if (fd >= 0 && connect(fd, entry->ai_addr, entry->ai_addrlen) < 0)
             {
-                if (!isdigit(g_input_number[i]))
-                {
-                    printf(RED"Input number invalid\n"RESET);
-                    isValid = 0; 
-                    return isValid; 
-                }
+                close(fd);
+                fd = -1;
             }
-            /*Valid input*/
-            isValid = 1;
         }
+        freeaddrinfo(addresses);
+    }
 
+    /*Answers are read without blocking, requests are short and sent at once*/
+    if (fd >= 0)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
     }
-    else
-    {}
-    
-    return isValid;
+
+    return fd;
 }
 
 /**************************************************************************************
- *                              COMPARE_2_STRING
+ *                               LOADGEN SEND
  **************************************************************************************/
-int compare_2_string(User* user)
+static int loadgen_send(loadgen_bot* bot, const char* line)
 {
-    int i;
-    int isAllCorrect = 1; 
-    int newCorrectGuess = 0; 
-    int newIncorrectGuess = 0;
-
-    /* Temporary array to track new correct guesses */
-    static char s_newCommonChar[LENGTH_NUMBER+1]; 
-
-    /*set new_common_char = "_ _ _ _ _ _ \0"*/
-    memset(s_newCommonChar, '_', LENGTH_NUMBER); 
-    s_newCommonChar[LENGTH_NUMBER] = '\0'; 
+    char request[LENGTH_NUMBER_MAX + 2];
+    size_t length = (size_t)snprintf(request, sizeof(request), "%s\n", line);
+    size_t offset = 0;
 
-    /* Compare and store the new common char */
-    for (i = 0; i < LENGTH_NUMBER; i++)
+    while (offset < length)
     {
-        if (g_magic_number[i] == g_input_number[i])
+        ssize_t sent = send(bot->fd, request + offset, length - offset, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR)
         {
-            s_newCommonChar[i] = g_magic_number[i]; 
-
-            /*Check new correct*/
-            if(s_newCommonChar[i] != g_common_char[i])
-            {
-               newCorrectGuess = 1;
-            }
+            continue;
         }
-        else
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
         {
-            isAllCorrect = 0;
-
-            /* Check if a previously correct guess is now incorrect */
-            if (g_common_char[i] == g_magic_number[i])
-            {
-                newIncorrectGuess = 1; 
-            }
+            /*Full socket buffer: the server is reading, retry shortly*/
+            sched_yield();
+            continue;
         }
-    }
- 
-    /* If there are new correct guesses, increment RightGuess */
-    if (newCorrectGuess && !newIncorrectGuess)
-    {
-        user->rightGuess++;
-    }
-
-    /* If there are new incorrect guesses on previously correct chars, decrement RightGuess */
-    if (newIncorrectGuess && !newCorrectGuess)
-    {
-        user->rightGuess--;
-
-        /*Make sure that Rightguess >= 0*/
-        if(user->rightGuess < 0)
+        if (sent <= 0)
         {
-            user->rightGuess = 0; 
+            return 0;
         }
+        offset += (size_t)sent;
     }
 
-    /* Update the common_char with new correct guesses */
-    strcpy(g_common_char, s_newCommonChar);
-
-    /* Print check */
-    printf("Result: %s\n", g_common_char);
-    printf("Right Guesses: %d\n", user->rightGuess);
-
-    return isAllCorrect; 
+    return 1;
 }
 
 /**************************************************************************************
- *                          UPDATE 10 HIGHEST PLAYER
+ *                             LOADGEN RUN SERVER
  **************************************************************************************/
-void update_player_table(User* user, player_table* top_players)
+static void loadgen_run_server(loadgen_worker* worker)
 {
-    float userRatio = (float)user->rightGuess / user->totalGuess;
-    int i, j;
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    long activeCount = 0;
+    char chunk[LOADGEN_RESPONSE_SIZE];
+
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0)
+    {
+        perror("Error creating epoll instance");
+        worker->failedBots += worker->botCount;
+        return;
+    }
+
+    /*One connection per bot, the menu printed at connection is its first answer*/
+    for (long i = 0; i < worker->botCount; i++)
+    {
+        loadgen_bot* bot = &worker->bots[i];
+
+        bot->sentTime = get_time_seconds();
+        bot->fd = loadgen_connect(worker->address);
 
-    for (i = 0; i < 10; i++) {
-        if (userRatio > top_players->luckyRatio[i] ||  (userRatio == top_players->luckyRatio[i] && user->timeRecord < top_players->timeRecord[i])) 
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = bot;
+        if (bot->fd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, bot->fd, &event) < 0)
         {
-            /* Shift lower ranking players down */
-            for (j = 9; j > i; j--) 
+            if (bot->fd >= 0)
             {
-                strcpy(top_players->playerName[j], top_players->playerName[j-1]);
-                top_players->luckyRatio[j] = top_players->luckyRatio[j-1];
-                top_players->timeRecord[j] = top_players->timeRecord[j-1];
+                close(bot->fd);
             }
+            bot->fd = -1;
+            bot->step = BOT_STEP_DONE;
+            worker->failedBots++;
+            continue;
+        }
+        activeCount++;
+    }
 
-            /* Insert the new player */
-            strcpy(top_players->playerName[i], user->userName);
-            top_players->luckyRatio[i] = userRatio;
-            top_players->timeRecord[i] = user->timeRecord;
+    while (activeCount > 0)
+    {
+        int eventCount = epoll_wait(epollFd, events, SERVER_MAX_EVENTS, LOADGEN_IDLE_TIMEOUT_MS);
+        if (eventCount < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (eventCount <= 0)
+        {
+            fprintf(stderr, "No answer of the server for %d ms\n", LOADGEN_IDLE_TIMEOUT_MS);
             break;
         }
-    }
-}
 
-/**************************************************************************************
- *                             SAVE 10 TOP PLAYERS
- **************************************************************************************/
-void save_player_table_to_file(const player_table* top_players)
-{
-    FILE* file = fopen("top_players.txt", "w");
+        for (int e = 0; e < eventCount; e++)
+        {
+            loadgen_bot* bot = events[e].data.ptr;
+            int isClosed = 0;
 
-    /*Check open file success*/
-    if (file == NULL) 
-    {
-        perror("Error opening file");
-        return;
+            for (;;)
+            {
+                ssize_t received = recv(bot->fd, chunk, sizeof(chunk), 0);
+                if (received > 0)
+                {
+                    loadgen_bot_output(bot, chunk, (size_t)received);
+                    continue;
+                }
+                isClosed = (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR));
+                break;
+            }
+
+            /*The answer is complete when the game waits for the next line (every prompt ends with ": ")*/
+            const char* line = NULL;
+            int isAnswered = (bot->responseLength >= 2 && strcmp(bot->response + bot->responseLength - 2, ": ") == 0);
+            if (isAnswered)
+            {
+                bot->answerTime = get_time_seconds();
+                line = loadgen_bot_answer(worker, bot);
+            }
+
+            if (line != NULL && !isClosed)
+            {
+                bot->sentTime = get_time_seconds();
+                if (loadgen_send(bot, line))
+                {
+                    continue;
+                }
+            }
+            else if (!isClosed && bot->step != BOT_STEP_DONE)
+            {
+                /*Waiting for the rest of the answer, or for the server to close after "Bye"*/
+                continue;
+            }
+
+            /*Closed connection: done after the exit request, failed otherwise*/
+            if (bot->step != BOT_STEP_EXIT && bot->step != BOT_STEP_DONE)
+            {
+                worker->failedBots++;
+            }
+            bot->step = BOT_STEP_DONE;
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, bot->fd, NULL);
+            close(bot->fd);
+            bot->fd = -1;
+            activeCount--;
+        }
     }
 
-    /*Save top players*/
-    fprintf(file, "TOP 10 PLAYERS TABLE\n");
-    for (int i = 0; i < 10; i++) 
+    /*Bots still waiting after the idle timeout*/
+    for (long i = 0; i < worker->botCount; i++)
     {
-        if (strlen(top_players->playerName[i]) > 0) 
+        if (worker->bots[i].fd >= 0)
         {
-            fprintf(file, "%d. %s - %.2f - %.2fs\n", i + 1, top_players->playerName[i], top_players->luckyRatio[i], top_players->timeRecord[i]);
+            close(worker->bots[i].fd);
+            worker->failedBots++;
         }
     }
-
-    fclose(file);
+    close(epollFd);
 }
 
 /**************************************************************************************
- *                             READ 10 TOP PLAYERS
+ *                             RUN LOADGEN WORKER
  **************************************************************************************/
-int read_player_table_from_file(player_table* top_players) 
+void* run_loadgen_worker(void* arg)
 {
-    FILE* file = fopen("top_players.txt", "r");
+    loadgen_worker* worker = (loadgen_worker*)arg;
 
-    /*Check open file action */
-    if (file == NULL) 
+    if (worker->address == NULL)
     {
-        perror("Error opening file");
-        return 0;
+        loadgen_run_engine(worker);
     }
-
-    int i = 0;
-    char line[1000];
-    int  skipFirstLine = 1;
-
-    // Initialize the player_table
-    for (int j = 0; j < 10; j++) 
+    else
     {
-        memset(top_players->playerName[j], '\0', LENGTH_STRING_MAX+1);
-        top_players->luckyRatio[j] = 0.0f;
-        top_players->timeRecord[j] = 0.0; 
+        loadgen_run_server(worker);
     }
 
-    while (fgets(line, sizeof(line), file) != NULL) 
+    return NULL;
+}
+
+/**************************************************************************************
+ *                                 RUN LOADGEN
+ **************************************************************************************/
+int run_loadgen(int argc, char* argv[])
+{
+    long botCount = (argc > 2) ? strtol(argv[2], NULL, 10) : 0;
+    long gamesPerBot = 1;
+    long mix[BOT_KIND_COUNT] = { 2, 6, 2 };
+    const char* address = NULL;
+    long threadCount = 1;
+    int digitCount = LENGTH_NUMBER;
+    uint64_t seed = (uint64_t)time(NULL);
+    int isSeedValid = 1;
+    int isPersistValid = 1;
+    int isMixValid = 1;
+    int isLogEnabled = 0;
+    long historyCapacity = GAME_HISTORY_DEFAULT_CAPACITY;
+
+    /*Parse options*/
+    for (int i = 3; i < argc; i++)
     {
-        /*Skip the first line*/
-        if (skipFirstLine) 
+        if (strcmp(argv[i], "--games") == 0 && i + 1 < argc)
         {
-            skipFirstLine = 0;
-            continue;
+            gamesPerBot = strtol(argv[++i], NULL, 10);
         }
-
-        if (i >= 10) 
+        else if (strcmp(argv[i], "--mix") == 0 && i + 1 < argc)
         {
-            break;
+            isMixValid = (sscanf(argv[++i], "%ld:%ld:%ld", &mix[BOT_KIND_RANDOM], &mix[BOT_KIND_SOLVER], &mix[BOT_KIND_QUITTER]) == 3 &&
+                          mix[BOT_KIND_RANDOM] >= 0 && mix[BOT_KIND_SOLVER] >= 0 && mix[BOT_KIND_QUITTER] >= 0 &&
+                          mix[BOT_KIND_RANDOM] + mix[BOT_KIND_SOLVER] + mix[BOT_KIND_QUITTER] > 0);
         }
-
-        /*Manually parse the line for player name, lucky ratio, and time record*/
-        char name[LENGTH_STRING_MAX + 1] = {0};
-        float ratio = 0.0f;
-        double time = 0.0;
-
-        /* Use sscanf to parse the line */
-        if (sscanf(line, "%*d. %s - %f - %lfs", name, &ratio, &time) == 3) 
+        else if (strcmp(argv[i], "--target") == 0 && i + 1 < argc)
+        {
+            address = (strcmp(argv[++i], "engine") == 0) ? NULL : argv[i];
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            threadCount = strtol(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--digits") == 0 && i + 1 < argc)
+        {
+            digitCount = parse_digit_count(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            isSeedValid = parse_seed(argv[++i], &seed);
+        }
+        else if (strcmp(argv[i], "--log") == 0)
+        {
+            isLogEnabled = 1;
+        }
+        else if (strcmp(argv[i], "--history") == 0 && i + 1 < argc)
+        {
+            historyCapacity = strtol(argv[++i], NULL, 10);
+        }
+        else if (parse_persist_option(argc, argv, &i, &isPersistValid))
+        {
+            continue;
+        }
+        else
         {
-            /* Store the parsed values*/
-            strcpy(top_players->playerName[i], name);
-            top_players->luckyRatio[i] = ratio;
-            top_players->timeRecord[i] = time;
-            i++;
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
         }
     }
 
-    fclose(file);
-    return 1;
-}
-
-/**************************************************************************************
- *                            PRINT 10 TOP PLAYERS
- **************************************************************************************/
-void print_high_score(player_table *top_players)
-{
-    printf("Top 10 Players read from file:\n");
-    for (int i = 0; i < 10; i++) 
+    if (botCount <= 0 || botCount > LOADGEN_MAX_BOTS || gamesPerBot <= 0 || !isMixValid || threadCount <= 0 || threadCount > LOADGEN_MAX_THREADS ||
+        (address != NULL && strncmp(address, "unix:", 5) != 0 && strncmp(address, "tcp:", 4) != 0) ||
+        historyCapacity <= 0 || historyCapacity > GAME_HISTORY_MAX_CAPACITY || digitCount == 0 || !isSeedValid || !isPersistValid)
     {
-        if (strlen(top_players->playerName[i]) > 0) 
-        {
-            printf("%d. %s - %.2f - %.2fs\n", i + 1, top_players->playerName[i], top_players->luckyRatio[i],top_players->timeRecord[i]);
-        }
+        fprintf(stderr, "Usage: %s --loadgen <bots 1..%d> [--games n] [--mix random:solver:quitter] [--target engine|unix:path|tcp:[host:]port]\n"
+                        "       [--threads 1..%d] [--digits %s] [--seed n] [--log] [--history 1..%ld] " PERSIST_USAGE "\n",
+                argv[0], LOADGEN_MAX_BOTS, LOADGEN_MAX_THREADS, DIGIT_COUNT_CHOICES, GAME_HISTORY_MAX_CAPACITY);
+        return 1;
     }
-}
 
-/**************************************************************************************
- *                            SAVE A LIST OF USER TO LOGFILE
- **************************************************************************************/
-void save_user_list_to_file(User users[]) {
-    FILE *file = fopen("log.txt", "w");
-    if (file == NULL) {
-        perror("Error opening file");
-        return;
+    loadgen_bot* bots = calloc((size_t)botCount, sizeof(loadgen_bot));
+    static loadgen_worker workers[LOADGEN_MAX_THREADS];
+    static game_store store;
+
+    if (bots == NULL)
+    {
+        perror("Error allocating bots");
+        return 1;
     }
 
-    for (int i = 0; i < 10; ++i) {
-        fprintf(file, "Entry %d:\n", i + 1); // Print the sequence number
-        fprintf(file, "Username: %s\n", users[i].userName);
-        fprintf(file, "Total Guesses: %d\n", users[i].totalGuess);
-        fprintf(file, "Right Guesses: %d\n", users[i].rightGuess);
-        fprintf(file, "Time Record: %.2f\n", users[i].timeRecord);
-        fprintf(file, "Magic Number: %s\n", g_magic_number_old[i]); // Save magic number as a string
-        fprintf(file, "Common Char: %s\n", g_common_char_old[i]);   // Save common char sequence
-        fprintf(file, "Magic numer guessed done: %d\n", g_is_all_correct_string[i]); 
-        fprintf(file, "-------------------------\n");
+    /*The in-process bots share one store, like the sessions of the server*/
+    if (address == NULL && !game_store_init(&store, isLogEnabled, (size_t)historyCapacity))
+    {
+        free(bots);
+        return 1;
     }
 
-    fclose(file);
-}
+    /*Bot kinds follow the mix in turn, every bot gets its own random stream*/
+    long mixTotal = mix[BOT_KIND_RANDOM] + mix[BOT_KIND_SOLVER] + mix[BOT_KIND_QUITTER];
+    long kindCounts[BOT_KIND_COUNT] = { 0 };
+    rng_state stream;
+    rng_seed(&stream, seed);
+    for (long i = 0; i < botCount; i++)
+    {
+        loadgen_bot* bot = &bots[i];
+        long position = i % mixTotal;
+
+        bot->kind = (position < mix[BOT_KIND_RANDOM]) ? BOT_KIND_RANDOM :
+                    (position < mix[BOT_KIND_RANDOM] + mix[BOT_KIND_SOLVER]) ? BOT_KIND_SOLVER : BOT_KIND_QUITTER;
+        kindCounts[bot->kind]++;
+        bot->step = BOT_STEP_CONNECT;
+        bot->gamesLeft = gamesPerBot;
+        bot->fd = -1;
+        snprintf(bot->userName, sizeof(bot->userName), "bot%d", (int)i);
+
+        game_session_init(&bot->session, 0);
+        bot->session.rng = stream;
+        bot->seed = (unsigned int)rng_next(&stream);
+        rng_jump(&stream);
+    }
 
-/**************************************************************************************
- *                            SAVE NEW USER TO LOGFILE
- **************************************************************************************/
-void save_user_to_file(User users[],User user, int isAllCorrect) {
-     
-    /* Remove the oldest user to make room for the new one */
-    for (int i = 9; i >= 0 ; i--) 
+    /*Split the bots across the threads*/
+    long firstBot = 0;
+    for (long i = 0; i < threadCount; i++)
     {
-        users[i+1] = users[i];
-        strcpy(g_magic_number_old[i+1], g_magic_number_old[i]); 
-        strcpy(g_common_char_old[i+1], g_common_char_old[i]); 
-        g_is_all_correct_string[i+1] = g_is_all_correct_string[i];
+        memset(&workers[i], 0, sizeof(workers[i]));
+        workers[i].bots = &bots[firstBot];
+        workers[i].botCount = botCount / threadCount + (i < botCount % threadCount ? 1 : 0);
+        workers[i].address = address;
+        workers[i].store = &store;
+        workers[i].digitCount = digitCount;
+        firstBot += workers[i].botCount;
     }
 
+    double startTime = get_time_seconds();
 
-    /* Add the new user */ 
-    users[0] = user;
-    strcpy(g_common_char_old[0], g_common_char);  
-    strcpy(g_magic_number_old[0], g_magic_number); 
-    g_is_all_correct_string[0] = isAllCorrect; 
+    for (long i = 0; i < threadCount; i++)
+    {
+        if (pthread_create(&workers[i].thread, NULL, run_loadgen_worker, &workers[i]) != 0)
+        {
+            /*Run it on this thread instead*/
+            run_loadgen_worker(&workers[i]);
+            workers[i].thread = pthread_self();
+        }
+    }
 
-    /* Save the updated user list to the file */
-    save_user_list_to_file(users);
-}
+    long totalGames = 0;
+    long totalGuesses = 0;
+    long totalRequests = 0;
+    long failedBots = 0;
+    for (long i = 0; i < threadCount; i++)
+    {
+        if (!pthread_equal(workers[i].thread, pthread_self()))
+        {
+            pthread_join(workers[i].thread, NULL);
+        }
+        totalGames += workers[i].games;
+        totalGuesses += workers[i].guesses;
+        totalRequests += workers[i].requests;
+        failedBots += workers[i].failedBots;
+    }
 
-/**************************************************************************************
- *                               LOAD LIST
- **************************************************************************************/
-int load_user_list_from_file(User users[], User user)
-{
-    FILE *file = fopen("log.txt", "r");
-    if (file == NULL) {
-        return 0; // No file exists, so no users to load
-    }
-
-    int count = 0;
-    int entryNumber;
-
-    /*clear struct*/
-    for (int i = 0; i < 10; i++) {
-        memset(users[i].userName, '\0', sizeof(users[i].userName));
-        users[i].rightGuess = 0;
-        users[i].totalGuess = 0;
-        users[i].timeRecord = 0.0f;
-    }
-
-    /*clear common_char_old + magic_number_old + isAllCorrect_string*/
-    memset(g_common_char_old,'\0', sizeof(g_common_char_old)); 
-    memset(g_magic_number_old,'\0',sizeof(g_magic_number_old));
-    memset(g_is_all_correct_string, 0, sizeof(g_is_all_correct_string)); 
-
-    /*Read data */
-    while(fscanf(file, "Entry %d:\n", &entryNumber) == 1 &&
-          fscanf(file, "Username: %20s\n", users[count].userName) == 1 &&
-          fscanf(file, "Total Guesses: %d\n", &users[count].totalGuess) == 1 &&
-          fscanf(file, "Right Guesses: %d\n", &users[count].rightGuess) == 1 &&
-          fscanf(file, "Time Record: %f\n", &users[count].timeRecord) == 1 &&
-          fscanf(file, "Magic Number: %s\n", g_magic_number_old[count]) == 1 && 
-          fscanf(file, "Common Char: %s\n", g_common_char_old[count]) == 1 && 
-          fscanf(file, "Magic numer guessed done: %d\n", &g_is_all_correct_string[count]) == 1) 
-          {   
-              fscanf(file, "-------------------------\n");
-              count++;
-              if (count >= 10) 
-              {
-                  break;
-              }
-          }
+    double elapsedTime = get_time_seconds() - startTime;
 
-    fclose(file);
+    /*Avoid division by zero on a very fast run*/
+    if (elapsedTime <= 0.0)
+    {
+        elapsedTime = 1e-9;
+    }
 
-    /*Check incompleting game account*/
-    for(int i = 0; i < 10; i++)
+    printf("LOAD GENERATOR REPORT\n");
+    printf("Target          : %s\n", (address != NULL) ? address : (isLogEnabled ? "engine (log + player table)" : "engine"));
+    printf("Bots            : %ld (%s %ld, %s %ld, %s %ld)\n", botCount,
+           s_bot_kind_names[BOT_KIND_RANDOM], kindCounts[BOT_KIND_RANDOM], s_bot_kind_names[BOT_KIND_SOLVER], kindCounts[BOT_KIND_SOLVER],
+           s_bot_kind_names[BOT_KIND_QUITTER], kindCounts[BOT_KIND_QUITTER]);
+    printf("Threads         : %ld\n", threadCount);
+    printf("Digits          : %d\n", digitCount);
+    printf("Seed            : %llu\n", (unsigned long long)seed);
+    printf("Games           : %ld (failed bots: %ld)\n", totalGames, failedBots);
+    printf("Guesses         : %ld\n", totalGuesses);
+    printf("Elapsed         : %.3fs\n", elapsedTime);
+    printf("Games/sec       : %.0f\n", totalGames / elapsedTime);
+    printf("Requests/sec    : %.0f\n", totalRequests / elapsedTime);
+    printf("%-10s %10s %10s %10s %10s %10s  (us)\n", "phase", "requests", "p50", "p90", "p99", "max");
+
+    /*Merge the latencies of the threads, phase by phase*/
+    for (int phase = 0; phase < LOADGEN_PHASE_COUNT; phase++)
     {
-        if(strcmp(users[i].userName, user.userName) == 0 && g_is_all_correct_string[i] == 0)
+        latency_samples merged = { NULL, 0, 0 };
+        for (long i = 0; i < threadCount; i++)
+        {
+            latency_samples* samples = &workers[i].samples[phase];
+            for (size_t s = 0; s < samples->count; s++)
+            {
+                latency_samples_push(&merged, samples->values[s]);
+            }
+            free(samples->values);
+        }
+
+        if (merged.count > 0)
         {
-            return i; 
+            qsort(merged.values, merged.count, sizeof(double), micro_bench_compare_samples);
+            printf("%-10s %10zu %10.1f %10.1f %10.1f %10.1f\n", s_loadgen_phase_names[phase], merged.count,
+                   merged.values[(merged.count - 1) / 2] * 1e6, merged.values[(merged.count - 1) * 90 / 100] * 1e6,
+                   merged.values[(merged.count - 1) * 99 / 100] * 1e6, merged.values[merged.count - 1] * 1e6);
         }
+        free(merged.values);
     }
 
-    return -1; 
+    if (address == NULL)
+    {
+        game_store_close(&store);
+    }
+
+    /*Group commit counters of the in-process store*/
+    if (address == NULL && isLogEnabled)
+    {
+        persist_stats stats;
+        persist_stats_read(&stats);
+        persist_stats_print(&stats);
+    }
+
+    free(bots);
+    return (failedBots == 0) ? 0 : 1;
 }
 
 /**************************************************************************************
  *                        EXECUTION UNIT TEST FUNCTION
  **************************************************************************************/
 
+/*Scoring rules shared by the unit tests and the test runner*/
+static const score_case s_score_cases[] = {
+    { 0x00, 0x01, 0, 1, 0 },                            /*new digit*/
+    { 0x01, 0x03, 1, 2, 0 },                            /*new digit, keeps the old one*/
+    { 0x03, 0x01, 2, 1, 0 },                            /*lost digit*/
+    { 0x03, 0x05, 2, 2, 0 },                            /*new and lost digits*/
+    { 0x01, 0x01, 1, 1, 0 },                            /*same digits*/
+    { 0x01, 0x00, 0, 0, 0 },                            /*lost digit, not under 0*/
+    { 0x00, DIGIT_MASK_ALL(LENGTH_NUMBER), 0, 1, 1 },   /*all digits*/
+};
+
 /**************************************************************************************
  *                       USER'S REQUEST ENTER  FUNCTION
  **************************************************************************************/
 void ut_enter_request(void)
 {
+    game_session ut_session;
+    game_session_init(&ut_session, 0);
+    ut_session.isAdmin = 1;
 
     printf("Test enter user's request(enter request if print request is same with label symbolized, function runs correctly):\nResult:\n");
     static char ut_user_request[3];
@@ -1341,7 +9049,7 @@ void ut_enter_request(void)
     memset(ut_user_request, '\0', 3);
 
     /*Input user request*/
-    enter_request(ut_user_request); 
+    enter_request(&ut_session, ut_user_request); 
 
     /*Print check*/
     printf("Request that user type: %s\n", ut_user_request);
@@ -1379,16 +9087,15 @@ void ut_input_user_name(void)
 void ut_random_6_digits_number(void)
 {
     char ut_magic_number[LENGTH_NUMBER+1]; 
+    game_session ut_session;
+    game_session_init(&ut_session, (uint64_t)time(NULL));
     printf("Test random number 6 digit functions:\nTest : "); 
 
     /*Test */
-    random_6_digits_number(); 
-    strcpy(ut_magic_number,g_magic_number); 
+    random_6_digits_number(&ut_session); 
+    packed_digits_format(&ut_session.magicNumber, DIGIT_MASK_ALL(LENGTH_NUMBER), LENGTH_NUMBER, ut_magic_number); 
     printf("%s\n",ut_magic_number);
     printf("End test\n"); 
-
-    /*Clear magic number*/
-    memset(g_magic_number,'\0',sizeof(g_magic_number)); 
 }
 
 /**************************************************************************************
@@ -1397,10 +9104,12 @@ void ut_random_6_digits_number(void)
 void ut_input_6_digits_number(void)
 {
     int ut_isvalid; 
+    game_session ut_session;
+    game_session_init(&ut_session, 0);
     printf("Test input 6 digits number function:\n"); 
 
     /*Test*/
-    ut_isvalid = input_6_digits_number(); 
+    ut_isvalid = input_6_digits_number(&ut_session); 
 
     /*Print result*/
     if (ut_isvalid == 1)
@@ -1409,9 +9118,6 @@ void ut_input_6_digits_number(void)
         printf("Game Stop\n"); 
 
     printf("End test.\n");
-
-    /*Clear g_input_number*/
-    memset(g_input_number,'\0',sizeof(g_input_number));
 }
 
 /**************************************************************************************
@@ -1420,40 +9126,58 @@ void ut_input_6_digits_number(void)
 void ut_compare_2_string(void)
 {
     User ut_user; 
+    game_session ut_session;
     int ut_isAllCorrect; 
+    char ut_common_char[LENGTH_NUMBER+1];
+
+    memset(&ut_user, 0, sizeof(ut_user));
+    game_session_init(&ut_session, 0);
+    ut_session.output = terminal_output;
 
     printf("Test compare string: \n"); 
     
     /*Test 1*/
     printf("Test 1: \n"); 
-    strcpy(g_magic_number,"234561\0"); 
-    strcpy(g_input_number,"234567\0"); 
+    ut_session.digitKernel->parse("234561", &ut_session.magicNumber); 
+    ut_session.digitKernel->parse("234567", &ut_session.inputNumber); 
 
-    ut_isAllCorrect = compare_2_string(&ut_user); 
+    ut_isAllCorrect = compare_2_string(&ut_session, &ut_user); 
 
-    printf("Guess all number: %d\nString common char: %s\n", ut_isAllCorrect, g_common_char); 
+    printf("Guess all number: %d\nString common char: %s\n", ut_isAllCorrect, packed_digits_format(&ut_session.magicNumber, ut_session.commonMask, LENGTH_NUMBER, ut_common_char)); 
 
     /*Test 2*/
     printf("Test 2: \n"); 
-    strcpy(g_input_number,"234551\0");
+    ut_session.digitKernel->parse("234551", &ut_session.inputNumber);
 
-    ut_isAllCorrect = compare_2_string(&ut_user); 
+    ut_isAllCorrect = compare_2_string(&ut_session, &ut_user); 
 
-    printf("Guess all number: %d\nString common char: %s\n", ut_isAllCorrect, g_common_char); 
+    printf("Guess all number: %d\nString common char: %s\n", ut_isAllCorrect, packed_digits_format(&ut_session.magicNumber, ut_session.commonMask, LENGTH_NUMBER, ut_common_char)); 
 
     /*Test 3*/
     printf("Test 3: \n"); 
-    strcpy(g_input_number,"234555\0");
+    ut_session.digitKernel->parse("234555", &ut_session.inputNumber);
 
-    ut_isAllCorrect = compare_2_string(&ut_user); 
+    ut_isAllCorrect = compare_2_string(&ut_session, &ut_user); 
 
-    printf("Guess all number: %d\nString common char: %s", ut_isAllCorrect, g_common_char);
+    printf("Guess all number: %d\nString common char: %s\n", ut_isAllCorrect, packed_digits_format(&ut_session.magicNumber, ut_session.commonMask, LENGTH_NUMBER, ut_common_char));
+
+    /*Test 4: scoring rules on match masks (previous mask, new mask, right guesses before and after)*/
+    printf("Test 4: ");
+    int ut_failed = 0;
+    for (size_t i = 0; i < sizeof(s_score_cases) / sizeof(s_score_cases[0]); i++)
+    {
+        const score_case* ut_case = &s_score_cases[i];
+        guess_score ut_score = score_guess(ut_case->commonMask, ut_case->matchMask, LENGTH_NUMBER, ut_case->rightGuess);
+        if (ut_score.rightGuess != ut_case->expected || ut_score.isAllCorrect != ut_case->isAllCorrect ||
+            ut_score.commonMask != ut_case->matchMask)
+        {
+            printf("\n  case %zu failed: right guesses %d (expected %d)", i + 1, ut_score.rightGuess, ut_case->expected);
+            ut_failed = 1;
+        }
+    }
+    printf("%s", ut_failed ? "\n" : "Scoring rules passed");
 
     printf("\nEnd test.\n");
-    /*Clear */
-    memset(g_common_char,'\0', sizeof(g_common_char)); 
-    memset(g_input_number,'\0', sizeof(g_input_number)); 
-    memset(g_magic_number,'\0', sizeof(g_magic_number));
 }
 
 /**************************************************************************************
@@ -1463,19 +9187,31 @@ void ut_load_read_save_print_top_file(void)
 {
     player_table ut_top_player; 
     User ut_user; 
+    game_session ut_session;
 
+    game_session_init(&ut_session, 0);
+    ut_session.output = terminal_output;
+    memset(&ut_user, 0, sizeof(ut_user));
     strcpy(ut_user.userName, "tes10"); 
+    ut_user.totalGuess = 10;
+    ut_user.rightGuess = 1;
+    if (!player_table_init(&ut_top_player))
+    {
+        return;
+    }
 
     /*Test read and print*/
     printf("Test funtion read, save, print and updata data with file top: \n"); 
     read_player_table_from_file(&ut_top_player); 
-    print_high_score(&ut_top_player); 
+    print_high_score(&ut_session, &ut_top_player); 
     printf("End test read and print.\n"); 
 
     /*Test save and print*/
     update_player_table(&ut_user,&ut_top_player); 
     save_player_table_to_file(&ut_top_player); 
-    print_high_score(&ut_top_player);    
+    export_player_table_to_text(&ut_top_player); 
+    print_high_score(&ut_session, &ut_top_player);    
+    player_table_free(&ut_top_player);
     printf("End test save and print.\n");
 }
 
@@ -1485,23 +9221,818 @@ void ut_load_read_save_print_top_file(void)
 void ut_save_and_load_file(void)
 {
     User ut_user; 
-    User ut_users[10]; 
+    game_session ut_session;
+    game_history ut_history; 
     int ut_isAllCorrect = 1; 
 
+    memset(&ut_user, 0, sizeof(ut_user));
+    game_session_init(&ut_session, 0);
+    if (!game_history_init(&ut_history, GAME_HISTORY_DEFAULT_CAPACITY))
+    {
+        return;
+    }
+
     printf("\nTest save and read data of file log:\n");
 
     /*Test*/
-    load_user_list_from_file(ut_users,ut_user); 
+    load_user_list_from_file(&ut_history,ut_user); 
     
     strcpy(ut_user.userName, "unit_test");
     ut_user.totalGuess = 12; 
 
-    save_user_to_file(ut_users,ut_user,ut_isAllCorrect); 
+    save_user_to_file(&ut_history,&ut_session,ut_user,ut_isAllCorrect); 
+    save_user_list_to_file(&ut_history);
+    game_history_free(&ut_history);
     printf("End test open file log.txt for checking.\n");
+}
+
+/**************************************************************************************
+ *                        EXECUTION TEST RUNNER FUNCTION
+ **************************************************************************************/
+
+/**************************************************************************************
+ *                                 TEST EXPECT
+ **************************************************************************************/
+static void test_expect(test_context* context, int isTrue, const char* condition, int line)
+{
+    context->checkCount++;
+    if (isTrue)
+    {
+        return;
+    }
+
+    context->failCount++;
+    size_t space = sizeof(context->messages) - context->messageLength;
+    int written = snprintf(context->messages + context->messageLength, space, "    line %d: %s\n", line, condition);
+    if (written > 0)
+    {
+        context->messageLength += ((size_t)written < space) ? (size_t)written : space - 1;
+    }
+}
+
+/**************************************************************************************
+ *                             TEST CAPTURE OUTPUT
+ **************************************************************************************/
+static void test_capture_output(void* context, const char* text, size_t length)
+{
+    test_output* output = (test_output*)context;
+    size_t space = sizeof(output->text) - 1 - output->length;
+
+    if (length > space)
+    {
+        length = space;
+    }
+    memcpy(output->text + output->length, text, length);
+    output->length += length;
+    output->text[output->length] = '\0';
+}
+
+/**************************************************************************************
+ *                             TEST CONSOLE BEGIN
+ **************************************************************************************/
+static line_reader s_test_saved_reader;
+static int s_test_saved_stdout = -1;
+
+static void test_console_begin(const char* input)
+{
+    /*The console functions read the scripted input from a pipe and print to /dev/null*/
+    fflush(stdout);
+    s_test_saved_reader = s_console_reader;
+    int inputFds[2];
+    if (pipe(inputFds) == 0)
+    {
+        if (write(inputFds[1], input, strlen(input)) < 0)
+        {
+            perror("Error writing test input");
+        }
+        close(inputFds[1]);
+        line_reader_init(&s_console_reader, inputFds[0], GAME_LINE_MAX);
+    }
+
+    s_test_saved_stdout = dup(STDOUT_FILENO);
+    int nullFd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (nullFd >= 0)
+    {
+        dup2(nullFd, STDOUT_FILENO);
+        close(nullFd);
+    }
+}
+
+/**************************************************************************************
+ *                              TEST CONSOLE END
+ **************************************************************************************/
+static void test_console_end(void)
+{
+    fflush(stdout);
+    if (s_console_reader.fd != s_test_saved_reader.fd)
+    {
+        close(s_console_reader.fd);
+    }
+    s_console_reader = s_test_saved_reader;
+
+    if (s_test_saved_stdout >= 0)
+    {
+        dup2(s_test_saved_stdout, STDOUT_FILENO);
+        close(s_test_saved_stdout);
+        s_test_saved_stdout = -1;
+    }
+}
 
-    /*Clear */
-    memset(g_common_char,'\0', sizeof(g_common_char)); 
-    memset(g_input_number,'\0', sizeof(g_input_number)); 
-    memset(g_magic_number,'\0', sizeof(g_magic_number));
-    memset(g_is_all_correct_string,0,sizeof(g_is_all_correct_string));
-}
\ No newline at end of file
+/**************************************************************************************
+ *                              TEST QUIET BEGIN
+ **************************************************************************************/
+static int s_test_saved_stderr = -1;
+
+static void test_quiet_begin(void)
+{
+    /*The errors a test provokes on purpose go to /dev/null, not into the report*/
+    fflush(stderr);
+    s_test_saved_stderr = dup(STDERR_FILENO);
+    int nullFd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (nullFd >= 0)
+    {
+        dup2(nullFd, STDERR_FILENO);
+        close(nullFd);
+    }
+}
+
+/**************************************************************************************
+ *                               TEST QUIET END
+ **************************************************************************************/
+static void test_quiet_end(void)
+{
+    fflush(stderr);
+    if (s_test_saved_stderr >= 0)
+    {
+        dup2(s_test_saved_stderr, STDERR_FILENO);
+        close(s_test_saved_stderr);
+        s_test_saved_stderr = -1;
+    }
+}
+
+/**************************************************************************************
+ *                               TEST CASES
+ **************************************************************************************/
+static void test_check_request(test_context* context)
+{
+    TEST_EXPECT(context, check_request("1", 0) == 1);
+    TEST_EXPECT(context, check_request("3", 0) == 1);
+    TEST_EXPECT(context, check_request("4", 0) == 0);
+    TEST_EXPECT(context, check_request("9", 1) == 1);
+    TEST_EXPECT(context, check_request("0", 1) == 0);
+    TEST_EXPECT(context, check_request("12", 0) == 0);
+    TEST_EXPECT(context, check_request("", 0) == 0);
+}
+
+static void test_check_user_name(test_context* context)
+{
+    TEST_EXPECT(context, check_user_name("alice") == 1);
+    TEST_EXPECT(context, check_user_name("Player01") == 1);
+    TEST_EXPECT(context, check_user_name("abcdefghijklmnopqrst") == 1);
+    TEST_EXPECT(context, check_user_name("abcdefghijklmnopqrstu") == 0);
+    TEST_EXPECT(context, check_user_name("bad name") == 0);
+    TEST_EXPECT(context, check_user_name("bad_name") == 0);
+}
+
+static void test_check_6_digits_number(test_context* context)
+{
+    const digit_kernel* kernel = digit_kernel_find(LENGTH_NUMBER);
+    const digit_kernel* kernel8 = digit_kernel_find(8);
+
+    TEST_EXPECT(context, check_6_digits_number("123456", kernel) == 1);
+    TEST_EXPECT(context, check_6_digits_number("12345", kernel) == 0);
+    TEST_EXPECT(context, check_6_digits_number("1234567", kernel) == 0);
+    TEST_EXPECT(context, check_6_digits_number("12a456", kernel) == 0);
+    TEST_EXPECT(context, check_6_digits_number("", kernel) == 0);
+    TEST_EXPECT(context, check_6_digits_number("quit", kernel) == -1);
+    TEST_EXPECT(context, check_6_digits_number("12345678", kernel8) == 1);
+    TEST_EXPECT(context, check_6_digits_number("123456", kernel8) == 0);
+}
+
+static void test_enter_request(test_context* context)
+{
+    game_session session;
+    char request[3];
+    game_session_init(&session, 0);
+
+    /*An invalid request is asked again*/
+    test_console_begin("7\n2\n");
+    enter_request(&session, request);
+    test_console_end();
+    TEST_EXPECT(context, strcmp(request, "2") == 0);
+
+    session.isAdmin = 1;
+    test_console_begin("8\n");
+    enter_request(&session, request);
+    test_console_end();
+    TEST_EXPECT(context, strcmp(request, "8") == 0);
+
+    /*End of input without a valid request*/
+    test_console_begin("0");
+    enter_request(&session, request);
+    test_console_end();
+    TEST_EXPECT(context, strcmp(request, "") == 0);
+}
+
+static void test_input_user_name(test_context* context)
+{
+    User user;
+    memset(&user, 0, sizeof(user));
+
+    test_console_begin("alice\n");
+    int isValid = input_user_name(&user);
+    test_console_end();
+    TEST_EXPECT(context, isValid == 1 && strcmp(user.userName, "alice") == 0);
+
+    test_console_begin("bad name\n");
+    isValid = input_user_name(&user);
+    test_console_end();
+    TEST_EXPECT(context, isValid == 0);
+
+    test_console_begin("abcdefghijklmnopqrstuvwxyz\n");
+    isValid = input_user_name(&user);
+    test_console_end();
+    TEST_EXPECT(context, isValid == 0);
+}
+
+static void test_line_reader(test_context* context)
+{
+    line_reader reader;
+    char* line;
+    int inputFds[2];
+    char overlong[3 * LINE_READER_SIZE];
+
+    if (pipe(inputFds) < 0)
+    {
+        TEST_EXPECT(context, !"pipe");
+        return;
+    }
+
+    /*Lines, carriage return, empty line, overlong line across chunks, last line without newline*/
+    memset(overlong, '7', sizeof(overlong));
+    overlong[sizeof(overlong) - 1] = '\n';
+    const char* head = "alpha\r\n\n";
+    const char* tail = "omega\nlast";
+    TEST_EXPECT(context, write(inputFds[1], head, strlen(head)) == (ssize_t)strlen(head));
+    TEST_EXPECT(context, write(inputFds[1], overlong, sizeof(overlong)) == (ssize_t)sizeof(overlong));
+    TEST_EXPECT(context, write(inputFds[1], tail, strlen(tail)) == (ssize_t)strlen(tail));
+    close(inputFds[1]);
+
+    line_reader_init(&reader, inputFds[0], GAME_LINE_MAX);
+    TEST_EXPECT(context, line_reader_read(&reader, &line) == 1 && strcmp(line, "alpha") == 0);
+    TEST_EXPECT(context, line_reader_read(&reader, &line) == 1 && strcmp(line, "") == 0);
+    TEST_EXPECT(context, line_reader_read(&reader, &line) == 0);
+    TEST_EXPECT(context, line_reader_read(&reader, &line) == 1 && strcmp(line, "omega") == 0);
+    TEST_EXPECT(context, line_reader_read(&reader, &line) == 1 && strcmp(line, "last") == 0);
+    TEST_EXPECT(context, line_reader_read(&reader, &line) == -1);
+    TEST_EXPECT(context, line_reader_read(&reader, &line) == -1);
+    close(inputFds[0]);
+
+    /*End of input in the middle of an overlong line*/
+    if (pipe(inputFds) < 0)
+    {
+        TEST_EXPECT(context, !"pipe");
+        return;
+    }
+    TEST_EXPECT(context, write(inputFds[1], overlong, GAME_LINE_MAX + 8) == GAME_LINE_MAX + 8);
+    close(inputFds[1]);
+    line_reader_init(&reader, inputFds[0], GAME_LINE_MAX);
+    TEST_EXPECT(context, line_reader_read(&reader, &line) == 0);
+    TEST_EXPECT(context, line_reader_read(&reader, &line) == -1);
+    close(inputFds[0]);
+}
+
+static void test_input_6_digits_number(test_context* context)
+{
+    game_session session;
+    packed_digits expected;
+    game_session_init(&session, 0);
+    session.digitKernel->parse("123456", &expected);
+
+    test_console_begin("123456\n");
+    int isValid = input_6_digits_number(&session);
+    test_console_end();
+    TEST_EXPECT(context, isValid == 1);
+    TEST_EXPECT(context, memcmp(&session.inputNumber, &expected, sizeof(expected)) == 0);
+
+    test_console_begin("quit\n");
+    isValid = input_6_digits_number(&session);
+    test_console_end();
+    TEST_EXPECT(context, isValid == -1);
+
+    test_console_begin("12a456\n");
+    isValid = input_6_digits_number(&session);
+    test_console_end();
+    TEST_EXPECT(context, isValid == 0);
+
+    test_console_begin("");
+    isValid = input_6_digits_number(&session);
+    test_console_end();
+    TEST_EXPECT(context, isValid == -1);
+}
+
+static void test_random_6_digits_number(test_context* context)
+{
+    game_session first;
+    game_session second;
+    game_session other;
+    game_session_init(&first, 42);
+    game_session_init(&second, 42);
+    game_session_init(&other, 43);
+
+    /*The same seed replays the same numbers, every nibble is a digit*/
+    int isSame = 1;
+    int isDigits = 1;
+    for (int i = 0; i < 100; i++)
+    {
+        random_6_digits_number(&first);
+        random_6_digits_number(&second);
+        isSame &= memcmp(&first.magicNumber, &second.magicNumber, sizeof(packed_digits)) == 0;
+
+        for (int d = 0; d < LENGTH_NUMBER; d++)
+        {
+            isDigits &= ((first.magicNumber.words[0] >> (4 * d)) & 0xF) <= 9;
+        }
+        isDigits &= (first.magicNumber.words[0] >> (4 * LENGTH_NUMBER)) == 0;
+    }
+    random_6_digits_number(&other);
+
+    TEST_EXPECT(context, isSame);
+    TEST_EXPECT(context, isDigits);
+    TEST_EXPECT(context, memcmp(&first.magicNumber, &other.magicNumber, sizeof(packed_digits)) != 0);
+}
+
+static void test_packed_digits(test_context* context)
+{
+    const digit_kernel* kernel = digit_kernel_find(LENGTH_NUMBER);
+    const digit_kernel* kernel64 = digit_kernel_find(LENGTH_NUMBER_MAX);
+    packed_digits magicNumber;
+    packed_digits inputNumber;
+    char text[LENGTH_NUMBER_MAX + 1];
+
+    kernel->parse("123456", &magicNumber);
+    kernel->parse("123999", &inputNumber);
+    TEST_EXPECT(context, kernel->match(&magicNumber, &inputNumber) == 0x07);
+    TEST_EXPECT(context, kernel->match(&magicNumber, &magicNumber) == DIGIT_MASK_ALL(LENGTH_NUMBER));
+    TEST_EXPECT(context, strcmp(packed_digits_format(&magicNumber, 0x05, LENGTH_NUMBER, text), "1_3___") == 0);
+    TEST_EXPECT(context, strcmp(packed_digits_format(&magicNumber, DIGIT_MASK_ALL(LENGTH_NUMBER), LENGTH_NUMBER, text), "123456") == 0);
+
+    const char* digits64 = "0123456789012345678901234567890123456789012345678901234567890123";
+    kernel64->parse(digits64, &magicNumber);
+    inputNumber = magicNumber;
+    inputNumber.words[3] ^= (uint64_t)1 << 60;
+    TEST_EXPECT(context, strcmp(packed_digits_format(&magicNumber, DIGIT_MASK_ALL(64), 64, text), digits64) == 0);
+    TEST_EXPECT(context, kernel64->match(&magicNumber, &inputNumber) == (DIGIT_MASK_ALL(64) & ~((digit_mask)1 << 63)));
+}
+
+static void test_compare_2_string(test_context* context)
+{
+    game_session session;
+    test_output output;
+    game_session_init(&session, 0);
+    session.output = test_capture_output;
+    session.outputContext = &output;
+    session.digitKernel->parse("234561", &session.magicNumber);
+
+    static const struct { const char* input; const char* result; int rightGuess; int isAllCorrect; } steps[] = {
+        { "234567", "Result: 23456_\n", 1, 0 },
+        { "234551", "Result: 2345_1\n", 1, 0 },
+        { "234555", "Result: 2345__\n", 0, 0 },
+        { "234561", "Result: 234561\n", 1, 1 },
+    };
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++)
+    {
+        output.length = 0;
+        output.text[0] = '\0';
+        session.digitKernel->parse(steps[i].input, &session.inputNumber);
+
+        int isAllCorrect = compare_2_string(&session, &session.user);
+        TEST_EXPECT(context, isAllCorrect == steps[i].isAllCorrect);
+        TEST_EXPECT(context, session.user.rightGuess == steps[i].rightGuess);
+        TEST_EXPECT(context, strstr(output.text, steps[i].result) != NULL);
+    }
+}
+
+static void test_score_guess(test_context* context)
+{
+    for (size_t i = 0; i < sizeof(s_score_cases) / sizeof(s_score_cases[0]); i++)
+    {
+        const score_case* scoreCase = &s_score_cases[i];
+        guess_score score = score_guess(scoreCase->commonMask, scoreCase->matchMask, LENGTH_NUMBER, scoreCase->rightGuess);
+
+        TEST_EXPECT(context, score.rightGuess == scoreCase->expected);
+        TEST_EXPECT(context, score.isAllCorrect == scoreCase->isAllCorrect);
+        TEST_EXPECT(context, score.commonMask == scoreCase->matchMask);
+    }
+}
+
+static void test_player_table(test_context* context)
+{
+    player_table table;
+    const player_node* players[3];
+    player_table_init(&table);
+
+    TEST_EXPECT(context, player_table_update(&table, "alice", 0.5f, 10.0f) == 1);
+    TEST_EXPECT(context, player_table_update(&table, "bob", 0.25f, 10.0f) == 1);
+    TEST_EXPECT(context, player_table_update(&table, "carol", 0.5f, 5.0f) == 1);
+
+    /*Ratio first, then the shorter time*/
+    TEST_EXPECT(context, player_table_rank(&table, "carol") == 1);
+    TEST_EXPECT(context, player_table_rank(&table, "alice") == 2);
+    TEST_EXPECT(context, player_table_rank(&table, "bob") == 3);
+    TEST_EXPECT(context, player_table_rank(&table, "dave") == 0);
+
+    /*Only the best result of a player is kept*/
+    TEST_EXPECT(context, player_table_update(&table, "alice", 0.1f, 1.0f) == 0);
+    TEST_EXPECT(context, player_table_update(&table, "bob", 1.0f, 20.0f) == 1);
+    TEST_EXPECT(context, player_table_top(&table, 3, players) == 3);
+    TEST_EXPECT(context, strcmp(players[0]->playerName, "bob") == 0);
+    TEST_EXPECT(context, strcmp(players[2]->playerName, "alice") == 0);
+    TEST_EXPECT(context, player_table_percentile(&table, 1) > 66.0f);
+
+    player_table_free(&table);
+}
+
+static void test_game_flow(test_context* context)
+{
+    game_store store;
+    game_session session;
+    test_output output;
+    char magicText[LENGTH_NUMBER_MAX + 1];
+    char wrongText[LENGTH_NUMBER_MAX + 1];
+
+    if (!game_store_init(&store, 0, 64))
+    {
+        TEST_EXPECT(context, !"store init");
+        return;
+    }
+    game_session_init(&session, 7);
+    session.store = &store;
+    session.output = test_capture_output;
+    session.outputContext = &output;
+    session.isPlain = 1;
+    output.length = 0;
+
+    game_session_start(&session);
+    game_step(&session, "1");
+    game_step(&session, "tester");
+    game_step(&session, "2");
+    TEST_EXPECT(context, session.state == GAME_STATE_PLAY);
+
+    packed_digits_format(&session.magicNumber, DIGIT_MASK_ALL(LENGTH_NUMBER), LENGTH_NUMBER, magicText);
+    strcpy(wrongText, magicText);
+    wrongText[0] = (char)('0' + (wrongText[0] - '0' + 1) % 10);
+
+    /*A wrong guess, then quit: the next game resumes the same magic number*/
+    game_step(&session, wrongText);
+    TEST_EXPECT(context, session.state == GAME_STATE_PLAY && session.user.totalGuess == 2);
+    game_step(&session, "abc");
+    TEST_EXPECT(context, strstr(output.text, "Input number invalid") != NULL);
+    game_step(&session, "quit");
+    TEST_EXPECT(context, session.state == GAME_STATE_MENU);
+
+    output.length = 0;
+    game_step(&session, "2");
+    TEST_EXPECT(context, strstr(output.text, "had not finnished the last game") != NULL);
+    TEST_EXPECT(context, strcmp(packed_digits_format(&session.magicNumber, DIGIT_MASK_ALL(LENGTH_NUMBER), LENGTH_NUMBER, wrongText), magicText) == 0);
+
+    /*The right guess wins, the player gets a rank*/
+    game_step(&session, magicText);
+    TEST_EXPECT(context, session.state == GAME_STATE_HIGH_SCORE);
+    TEST_EXPECT(context, strstr(output.text, "CONGRATULATION") != NULL);
+    TEST_EXPECT(context, strstr(output.text, "Your rank: 1 of 1 players") != NULL);
+    TEST_EXPECT(context, session.user.totalGuess == 2);
+    game_step(&session, "n");
+    TEST_EXPECT(context, session.state == GAME_STATE_MENU);
+    game_step(&session, "3");
+    TEST_EXPECT(context, session.state == GAME_STATE_STOPPED);
+
+    game_store_close(&store);
+}
+
+static void test_persistence(test_context* context)
+{
+    char directory[SCRATCH_DIRECTORY_SIZE];
+    char previousDirectory[4096];
+    game_store store;
+    game_session session;
+
+    if (!scratch_directory_enter(directory, previousDirectory, sizeof(previousDirectory)))
+    {
+        TEST_EXPECT(context, !"scratch directory");
+        return;
+    }
+
+    /*An unfinished game and a won game, saved to the files*/
+    TEST_EXPECT(context, game_store_init(&store, 1, 64));
+    game_session_init(&session, 11);
+    session.store = &store;
+    game_session_start(&session);
+    game_step(&session, "1");
+    game_step(&session, "saver");
+    game_step(&session, "2");
+    packed_digits savedMagicNumber = session.magicNumber;
+    game_step(&session, "quit");
+    game_step(&session, "1");
+    game_step(&session, "winner");
+    game_step(&session, "2");
+
+    char magicText[LENGTH_NUMBER_MAX + 1];
+    game_step(&session, packed_digits_format(&session.magicNumber, DIGIT_MASK_ALL(LENGTH_NUMBER), LENGTH_NUMBER, magicText));
+    TEST_EXPECT(context, session.state == GAME_STATE_HIGH_SCORE);
+    game_store_close(&store);
+
+    TEST_EXPECT(context, access(LOG_RING_FILE, F_OK) == 0);
+    TEST_EXPECT(context, access(PLAYER_FILE, F_OK) == 0);
+
+    /*The exports replace the files, no copy is left behind*/
+    TEST_EXPECT(context, access("log.txt", F_OK) == 0 && access("log.txt.tmp", F_OK) != 0);
+    TEST_EXPECT(context, access("top_players.txt", F_OK) == 0 && access("top_players.txt.tmp", F_OK) != 0);
+    TEST_EXPECT(context, access(PLAYER_FILE ".tmp", F_OK) != 0);
+
+    /*Loading the files gives back the games and the player table*/
+    TEST_EXPECT(context, game_store_init(&store, 1, 64));
+    const pending_slot* pending = pending_index_find(store.pending, "saver");
+    TEST_EXPECT(context, pending != NULL && memcmp(&pending->magicNumber, &savedMagicNumber, sizeof(savedMagicNumber)) == 0);
+    TEST_EXPECT(context, pending_index_find(store.pending, "winner") == NULL);
+    TEST_EXPECT(context, store.history.count == 2);
+    TEST_EXPECT(context, player_table_rank(&store.topPlayers, "winner") == 1);
+    game_store_close(&store);
+
+    /*An index which missed the games gets them from the ring file: the quit one is saved
+      again, the won one removed*/
+    pending_index index;
+    User ghost;
+    memset(&ghost, 0, sizeof(ghost));
+    strcpy(ghost.userName, "winner");
+    TEST_EXPECT(context, pending_index_open(&index, PENDING_INDEX_FILE));
+    TEST_EXPECT(context, index.header->appliedSequence == 2);
+    pending_index_remove(&index, "saver");
+    TEST_EXPECT(context, pending_index_put(&index, ghost, &savedMagicNumber, 0, LENGTH_NUMBER));
+    index.appliedSequence = 0;
+    pending_index_close(&index);
+
+    TEST_EXPECT(context, game_store_init(&store, 1, 64));
+    TEST_EXPECT(context, pending_index_find(store.pending, "saver") != NULL);
+    TEST_EXPECT(context, pending_index_find(store.pending, "winner") == NULL);
+    game_store_close(&store);
+
+    /*An index ahead of the ring file is rebuilt from it*/
+    strcpy(ghost.userName, "ghost");
+    TEST_EXPECT(context, pending_index_open(&index, PENDING_INDEX_FILE));
+    TEST_EXPECT(context, pending_index_put(&index, ghost, &savedMagicNumber, 0, LENGTH_NUMBER));
+    index.appliedSequence = 5;
+    pending_index_close(&index);
+
+    TEST_EXPECT(context, game_store_init(&store, 1, 64));
+    TEST_EXPECT(context, pending_index_find(store.pending, "ghost") == NULL);
+    TEST_EXPECT(context, pending_index_find(store.pending, "saver") != NULL);
+
+    /*The table image written and synced through an io_uring (if there is one) loads the same*/
+    io_ring ring;
+    persist_options savedOptions = s_persist_options;
+    int isRingReady = io_ring_init(&ring, IO_RING_ENTRIES);
+    s_persist_options.mode = PERSIST_SYNC_BATCH;
+    TEST_EXPECT(context, player_table_save(&store.topPlayers, isRingReady ? &ring : NULL) == 1);
+    s_persist_options = savedOptions;
+    io_ring_free(&ring);
+    game_store_close(&store);
+
+    TEST_EXPECT(context, access(PLAYER_FILE ".tmp", F_OK) != 0);
+    TEST_EXPECT(context, game_store_init(&store, 1, 64));
+    TEST_EXPECT(context, player_table_rank(&store.topPlayers, "winner") == 1);
+    game_store_close(&store);
+
+    /*With a sync mode the header names a record once the slots holding its changes are synced*/
+    log_record record;
+    memset(&record, 0, sizeof(record));
+    strcpy(record.userName, "late");
+    record.digitCount = LENGTH_NUMBER;
+    record.sequence = 100;
+    TEST_EXPECT(context, pending_index_open(&index, PENDING_INDEX_FILE));
+    uint64_t savedSequence = index.header->appliedSequence;
+    s_persist_options.mode = PERSIST_SYNC_BATCH;
+    TEST_EXPECT(context, pending_index_apply(&index, &record));
+    TEST_EXPECT(context, index.header->appliedSequence == savedSequence && index.appliedSequence == 100);
+    pending_index_sync(&index);
+    TEST_EXPECT(context, index.header->appliedSequence == 100);
+    s_persist_options = savedOptions;
+    pending_index_close(&index);
+
+    scratch_directory_leave(directory, previousDirectory);
+}
+
+static void test_group_commit(test_context* context)
+{
+    char directory[SCRATCH_DIRECTORY_SIZE];
+    char previousDirectory[4096];
+    game_store store;
+    game_session session;
+    test_output output;
+    persist_stats before;
+    persist_stats after;
+    persist_options savedOptions = s_persist_options;
+
+    if (!scratch_directory_enter(directory, previousDirectory, sizeof(previousDirectory)))
+    {
+        TEST_EXPECT(context, !"scratch directory");
+        return;
+    }
+
+    /*A batch wrapping around the end of the ring keeps the newest games*/
+    log_record records[13];
+    memset(records, 0, sizeof(records));
+    for (int i = 0; i < 13; i++)
+    {
+        snprintf(records[i].userName, sizeof(records[i].userName), "g%d", i);
+        records[i].digitCount = LENGTH_NUMBER;
+    }
+    pthread_mutex_lock(&s_file_mutex);
+    TEST_EXPECT(context, log_ring_open(8) && s_log_ring_next == 1);
+    TEST_EXPECT(context, log_ring_write(records, 8) == 2);
+
+    /*Reopening finds the newest game: in slot 0, then after the wrap*/
+    log_ring_close();
+    TEST_EXPECT(context, log_ring_open(8) && s_log_ring_next == 9);
+    TEST_EXPECT(context, log_ring_write(&records[8], 5) == 1);
+    log_ring_close();
+    TEST_EXPECT(context, log_ring_open(8) && s_log_ring_next == 14);
+    pthread_mutex_unlock(&s_file_mutex);
+
+    game_history history;
+    TEST_EXPECT(context, game_history_init(&history, 8));
+    pthread_mutex_lock(&s_file_mutex);
+    TEST_EXPECT(context, log_ring_load(&history) == 8);
+    pthread_mutex_unlock(&s_file_mutex);
+    TEST_EXPECT(context, strcmp(game_history_at(&history, 0)->user.userName, "g12") == 0);
+    TEST_EXPECT(context, strcmp(game_history_at(&history, 7)->user.userName, "g5") == 0);
+    game_history_free(&history);
+
+    /*A hole left by a lost batch in the middle of the newest games is skipped*/
+    log_record hole[2];
+    memset(hole, 0, sizeof(hole));
+    pthread_mutex_lock(&s_file_mutex);
+    log_ring_close();
+    unlink(LOG_RING_FILE);
+    TEST_EXPECT(context, log_ring_open(16) && log_ring_write(records, 10) == 1);
+    TEST_EXPECT(context, pwrite(s_log_ring_fd, hole, sizeof(hole), (off_t)(sizeof(log_ring_header) + 7 * sizeof(log_record))) == (ssize_t)sizeof(hole));
+    log_ring_close();
+    TEST_EXPECT(context, log_ring_open(16) && s_log_ring_next == 11);
+
+    /*The slots of a failed batch are given back, unless later games took the next ones*/
+    log_ring_release(&records[8], 2);
+    TEST_EXPECT(context, s_log_ring_next == 9);
+    log_ring_release(&records[0], 2);
+    TEST_EXPECT(context, s_log_ring_next == 9);
+    log_ring_close();
+    unlink(LOG_RING_FILE);
+    pthread_mutex_unlock(&s_file_mutex);
+    scratch_directory_leave(directory, previousDirectory);
+
+    /*Commit mode: a game goes on once its record is written and synced*/
+    TEST_EXPECT(context, scratch_directory_enter(directory, previousDirectory, sizeof(previousDirectory)));
+    s_persist_options.mode = PERSIST_SYNC_COMMIT;
+    s_persist_options.intervalMs = 0;
+    s_persist_options.batchSize = 4;
+    persist_stats_read(&before);
+
+    TEST_EXPECT(context, game_store_init(&store, 1, 64));
+    TEST_EXPECT(context, store.writer != NULL);
+    game_session_init(&session, 13);
+    session.store = &store;
+    game_session_start(&session);
+    game_step(&session, "1");
+    game_step(&session, "syncer");
+    game_step(&session, "2");
+    game_step(&session, "quit");
+    if (store.writer != NULL)
+    {
+        pthread_mutex_lock(&store.writer->mutex);
+        TEST_EXPECT(context, store.writer->queuedCount == 1 && store.writer->writtenCount == 1);
+        pthread_mutex_unlock(&store.writer->mutex);
+
+        /*A front end which must not block gets the ticket, and polls it*/
+        session.isCommitDeferred = 1;
+        game_step(&session, "2");
+        game_step(&session, "quit");
+        TEST_EXPECT(context, session.commitTicket == 2);
+        persist_writer_flush(store.writer);
+        TEST_EXPECT(context, game_session_commit_poll(&session) && session.commitTicket == 0);
+        session.isCommitDeferred = 0;
+    }
+
+    /*A failed write is reported to the player, the durable mark stays before it*/
+    pthread_mutex_lock(&s_file_mutex);
+    int ringFd = dup(s_log_ring_fd);
+    int fullFd = open("/dev/full", O_WRONLY | O_CLOEXEC);
+    TEST_EXPECT(context, ringFd >= 0 && fullFd >= 0 && dup2(fullFd, s_log_ring_fd) >= 0);
+    pthread_mutex_unlock(&s_file_mutex);
+
+    session.output = test_capture_output;
+    session.outputContext = &output;
+    session.isPlain = 1;
+    output.length = 0;
+    test_quiet_begin();
+    game_step(&session, "2");
+    game_step(&session, "quit");
+    test_quiet_end();
+    TEST_EXPECT(context, strstr(output.text, "The game could not be saved") != NULL);
+    if (store.writer != NULL)
+    {
+        pthread_mutex_lock(&store.writer->mutex);
+        TEST_EXPECT(context, store.writer->writtenCount == 3 && store.writer->durableCount == 2);
+        pthread_mutex_unlock(&store.writer->mutex);
+    }
+
+    pthread_mutex_lock(&s_file_mutex);
+    dup2(ringFd, s_log_ring_fd);
+    pthread_mutex_unlock(&s_file_mutex);
+    close(ringFd);
+    close(fullFd);
+
+    /*The next batch is saved again, the failed record stays failed*/
+    output.length = 0;
+    output.text[0] = '\0';
+    game_step(&session, "2");
+    game_step(&session, "quit");
+    TEST_EXPECT(context, strstr(output.text, "The game could not be saved") == NULL);
+    if (store.writer != NULL)
+    {
+        TEST_EXPECT(context, persist_writer_check(store.writer, 4) == 1 && store.writer->durableCount == 4);
+        TEST_EXPECT(context, persist_writer_check(store.writer, 3) == 0 && persist_writer_check(store.writer, 2) == 1);
+    }
+    game_store_close(&store);
+    s_persist_options = savedOptions;
+
+    persist_stats_read(&after);
+    TEST_EXPECT(context, after.recordCount - before.recordCount == 4);
+    TEST_EXPECT(context, after.syncCount - before.syncCount == 4);
+    TEST_EXPECT(context, after.batchSizes[0] - before.batchSizes[0] == 4);
+    TEST_EXPECT(context, after.failedBatchCount - before.failedBatchCount == 1);
+
+    scratch_directory_leave(directory, previousDirectory);
+}
+
+/*Test cases, in the order of the report*/
+static const test_case s_test_cases[] = {
+    { "check_request",          test_check_request },
+    { "check_user_name",        test_check_user_name },
+    { "check_6_digits_number",  test_check_6_digits_number },
+    { "enter_request",          test_enter_request },
+    { "input_user_name",        test_input_user_name },
+    { "line_reader",            test_line_reader },
+    { "input_6_digits_number",  test_input_6_digits_number },
+    { "random_6_digits_number", test_random_6_digits_number },
+    { "packed_digits",          test_packed_digits },
+    { "compare_2_string",       test_compare_2_string },
+    { "score_guess",            test_score_guess },
+    { "player_table",           test_player_table },
+    { "game_flow",              test_game_flow },
+    { "persistence",            test_persistence },
+    { "group_commit",           test_group_commit },
+};
+
+/**************************************************************************************
+ *                                 RUN TESTS
+ **************************************************************************************/
+int run_tests(int argc, char* argv[])
+{
+    const char* filter = (argc > 2) ? argv[2] : NULL;
+    int passedCount = 0;
+    int failedCount = 0;
+    double totalTime = 0.0;
+
+    printf("TEST RUNNER\n");
+
+    for (size_t i = 0; i < sizeof(s_test_cases) / sizeof(s_test_cases[0]); i++)
+    {
+        const test_case* testCase = &s_test_cases[i];
+        if (filter != NULL && strstr(testCase->name, filter) == NULL)
+        {
+            continue;
+        }
+
+        test_context context;
+        memset(&context, 0, sizeof(context));
+
+        double startTime = get_time_seconds();
+        testCase->run(&context);
+        double elapsedTime = get_time_seconds() - startTime;
+        totalTime += elapsedTime;
+
+        int isPassed = (context.failCount == 0 && context.checkCount > 0);
+        printf("%s  %-24s %9.3f ms  (%d checks)\n", isPassed ? "PASS" : "FAIL", testCase->name, elapsedTime * 1e3, context.checkCount);
+        if (!isPassed)
+        {
+            printf("%s", context.messages);
+            failedCount++;
+        }
+        else
+        {
+            passedCount++;
+        }
+    }
+
+    printf("Result          : %d passed, %d failed (%.3f ms)\n", passedCount, failedCount, totalTime * 1e3);
+    return (failedCount == 0 && passedCount > 0) ? 0 : 1;
+}